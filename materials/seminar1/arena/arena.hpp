@@ -0,0 +1,205 @@
+// Monotonic (bump) arena with O(1) scoped reset and a std::pmr adapter, see readme.md.
+//
+// Memory is taken from a chain of blocks by moving a pointer; nothing is freed individually. A Scope remembers
+// the position and rewinds to it when destroyed, so everything a request allocated is released at once.
+// Blocks behind the position are kept and reused by the next allocations, so a steady request loop does not
+// call malloc at all after warming up.
+//
+// -DARENA_GUARD_PAGES (debug builds): every allocation gets its own pages with an inaccessible page right after
+// the object, so an overflow faults at once, and rewinding a scope unmaps them, so a use after reset faults too.
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef ARENA_GUARD_PAGES
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace arena {
+
+class Arena {
+    struct Block;
+
+public:
+    static constexpr size_t MIN_BLOCK = 64 * 1024;
+
+    explicit Arena(size_t first_block = MIN_BLOCK) : next_size_(std::max(first_block, MIN_BLOCK)) {}
+
+    ~Arena() {
+#ifdef ARENA_GUARD_PAGES
+        unmap_from(0);
+#endif
+        for (Block* b = head_; b;) {
+            Block* next = b->next;
+            free(b);
+            b = next;
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** size bytes aligned to align (a power of two); never returns nullptr, throws std::bad_alloc. */
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+#ifdef ARENA_GUARD_PAGES
+        return guarded(size, align);
+#else
+        uintptr_t p = (ptr_ + align - 1) & ~(uintptr_t)(align - 1);
+        if (p + size <= end_ && ptr_ != 0) {
+            ptr_ = p + size;
+            return (void*)p;
+        }
+        return allocate_slow(size, align);
+#endif
+    }
+
+    /** Constructs a T; its destructor is never called, so T should be trivially destructible or own no resources. */
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /** Uninitialized array of n T, the arena version of new T[n]. */
+    template <class T>
+    T* make_array(size_t n) {
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    /** Position to rewind to: everything allocated after it is released by reset(). */
+    struct Mark {
+        Block* block;
+        uintptr_t ptr;
+        size_t allocations;   // guard pages mode
+    };
+
+    Mark mark() const { return Mark{cur_, ptr_, guarded_.size()}; }
+
+    /** O(1): the following allocations reuse the memory after the mark. */
+    void reset(const Mark& m) {
+#ifdef ARENA_GUARD_PAGES
+        unmap_from(m.allocations);
+#endif
+        cur_ = m.block;
+        ptr_ = m.ptr;
+        end_ = cur_ ? (uintptr_t)cur_ + cur_->size : 0;
+    }
+
+    /** Rewinds to empty; the blocks are kept. */
+    void reset() { reset(Mark{head_, head_ ? first_ptr(head_) : 0, 0}); }
+
+    /** RAII scope: rewinds the arena to where it was at construction. Scopes nest. */
+    class Scope {
+    public:
+        explicit Scope(Arena& a) : arena_(a), mark_(a.mark()) {}
+        ~Scope() { arena_.reset(mark_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena& arena_;
+        Mark mark_;
+    };
+
+    /** Bytes of all blocks taken from malloc. */
+    size_t reserved() const {
+        size_t n = 0;
+        for (Block* b = head_; b; b = b->next)
+            n += b->size;
+        return n;
+    }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;   // including this header
+    };
+
+    static uintptr_t first_ptr(Block* b) { return (uintptr_t)b + sizeof(Block); }
+
+    void* allocate_slow(size_t size, size_t align) {
+        // the next kept block if the request fits there, else a new block linked right after the current one
+        Block* next = cur_ ? cur_->next : head_;
+        size_t need = sizeof(Block) + size + align;
+        if (!next || next->size < need) {
+            size_t bytes = std::max(next_size_, need);
+            next_size_ = std::min(2 * next_size_, size_t(64) << 20);
+            Block* b = (Block*)malloc(bytes);
+            if (!b)
+                throw std::bad_alloc();
+            b->size = bytes;
+            b->next = next;
+            if (cur_)
+                cur_->next = b;
+            else
+                head_ = b;
+            next = b;
+        }
+        cur_ = next;
+        ptr_ = first_ptr(cur_);
+        end_ = (uintptr_t)cur_ + cur_->size;
+        uintptr_t p = (ptr_ + align - 1) & ~(uintptr_t)(align - 1);
+        ptr_ = p + size;
+        return (void*)p;
+    }
+
+#ifdef ARENA_GUARD_PAGES
+    void* guarded(size_t size, size_t align) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t data_pages = (size + align + page - 1) / page;
+        size_t bytes = (data_pages + 1) * page;
+        char* base = (char*)mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED)
+            throw std::bad_alloc();
+        char* guard = base + data_pages * page;
+        mprotect(guard, page, PROT_NONE);
+        guarded_.push_back({base, bytes});
+        // as close to the guard page as the alignment allows
+        return (void*)((uintptr_t)(guard - size) & ~(uintptr_t)(align - 1));
+    }
+
+    void unmap_from(size_t n) {
+        for (size_t i = n; i < guarded_.size(); i++)
+            munmap(guarded_[i].first, guarded_[i].second);
+        guarded_.resize(std::min(n, guarded_.size()));
+    }
+#endif
+
+    Block* head_ = nullptr;
+    Block* cur_ = nullptr;   // block of ptr_, nullptr before the first allocation
+    uintptr_t ptr_ = 0;
+    uintptr_t end_ = 0;
+    size_t next_size_;
+    std::vector<std::pair<char*, size_t>> guarded_;   // ARENA_GUARD_PAGES: live mappings in allocation order
+};
+
+/**
+ * std::pmr adapter: containers allocate from the arena, deallocate is a no-op
+ * (the memory comes back when the arena or a Scope is reset).
+ */
+class Resource : public std::pmr::memory_resource {
+public:
+    explicit Resource(Arena& a) : arena_(a) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override { return arena_.allocate(bytes, align); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        auto* r = dynamic_cast<const Resource*>(&other);
+        return r && &r->arena_ == &arena_;
+    }
+
+    Arena& arena_;
+};
+
+} // namespace arena
+
+#endif // ARENA_HPP
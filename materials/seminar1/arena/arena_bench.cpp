@@ -0,0 +1,105 @@
+// Request-style allocate-and-discard: objects like A of ../6.c (new int[a] in the constructor) and pmr
+// containers, from glibc malloc, from the arena with a Scope per request and from std::pmr::monotonic_buffer_resource.
+//   g++ -O2 -std=c++17 arena_bench.cpp -o arena_bench && ./arena_bench
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+// A of 6.c
+struct A {
+    const int a;
+    int b = 0;
+    int* p;
+
+    explicit A(int a) : a(a), p(new int[a]) {}
+    A(arena::Arena& ar, int a) : a(a), p(ar.make_array<int>(a)) {}   // freed with the arena scope
+    ~A() = default;
+};
+
+static std::vector<int> request_sizes() {
+    std::mt19937 rng(1);
+    std::vector<int> v(64);   // one request creates 64 objects of 4..260 ints
+    for (int& x : v)
+        x = 4 + rng() % 256;
+    return v;
+}
+
+static void bm_request_new_delete(bench::State& st) {
+    std::vector<int> sizes = request_sizes();
+    std::vector<A*> objs(sizes.size());
+    while (st.keep_running()) {
+        for (size_t i = 0; i < sizes.size(); i++) {
+            objs[i] = new A(sizes[i]);
+            objs[i]->p[0] = 1;
+        }
+        bench::do_not_optimize(objs);
+        for (A* o : objs) {
+            delete[] o->p;
+            delete o;
+        }
+    }
+    st.set_items_per_iteration(2 * sizes.size());
+}
+
+static void bm_request_arena(bench::State& st) {
+    std::vector<int> sizes = request_sizes();
+    std::vector<A*> objs(sizes.size());
+    arena::Arena ar;
+    while (st.keep_running()) {
+        arena::Arena::Scope scope(ar);
+        for (size_t i = 0; i < sizes.size(); i++) {
+            objs[i] = ar.make<A>(ar, sizes[i]);
+            objs[i]->p[0] = 1;
+        }
+        bench::do_not_optimize(objs);
+    }
+    st.set_items_per_iteration(2 * sizes.size());
+}
+
+// a request parsing arg fields into a vector of strings (longer than the SSO buffer)
+static void bm_pmr_default(bench::State& st) {
+    std::string field(40, 'x');
+    while (st.keep_running()) {
+        std::pmr::vector<std::pmr::string> v;
+        for (long i = 0; i < st.arg(); i++)
+            v.emplace_back(field);
+        bench::do_not_optimize(v);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static void bm_pmr_arena(bench::State& st) {
+    std::string field(40, 'x');
+    arena::Arena ar;
+    arena::Resource res(ar);
+    while (st.keep_running()) {
+        arena::Arena::Scope scope(ar);
+        std::pmr::vector<std::pmr::string> v(&res);
+        for (long i = 0; i < st.arg(); i++)
+            v.emplace_back(field);
+        bench::do_not_optimize(v);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static void bm_pmr_monotonic(bench::State& st) {
+    std::string field(40, 'x');
+    while (st.keep_running()) {
+        std::pmr::monotonic_buffer_resource res;   // the standard one: no reuse across requests
+        std::pmr::vector<std::pmr::string> v(&res);
+        for (long i = 0; i < st.arg(); i++)
+            v.emplace_back(field);
+        bench::do_not_optimize(v);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+BENCH(bm_request_new_delete);
+BENCH(bm_request_arena);
+BENCH(bm_pmr_default, 16, 1024);
+BENCH(bm_pmr_arena, 16, 1024);
+BENCH(bm_pmr_monotonic, 16, 1024);
+BENCH_MAIN();
@@ -0,0 +1,298 @@
+// Typed pool of fixed-size objects: slabs, intrusive free lists, per-thread magazines, see readme.md.
+//
+// Objects are carved from 64 KiB slabs; a free object stores the free-list link in its own first word.
+// Every thread keeps a magazine of up to 2 * BATCH free objects per pool, so create/destroy touch only
+// thread-local memory. A full magazine gives BATCH objects (one linked list) to the pool's depot, an empty one
+// takes a list from the depot or carves BATCH new objects; the depot is the only shared state and is locked
+// once per BATCH operations. A destroyed pool is dropped by the destroying thread at once and by every other thread
+// at its next magazine lookup (or exit); the slabs are freed with the last one.
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pool {
+
+constexpr size_t SLAB = 64 * 1024;   // bytes, slabs are aligned to it
+constexpr size_t BATCH = 64;         // objects moved between a magazine and the depot at once
+
+/** Occupancy of the slabs, see ObjectPool::stats. */
+struct Stats {
+    size_t slabs = 0;
+    size_t slots = 0;             // objects carved from the slabs
+    size_t live = 0;              // created and not destroyed
+    size_t cached = 0;            // free in thread magazines
+    size_t depot = 0;             // free in the depot
+    size_t histogram[5] = {};     // slabs by live share: 0%, <25%, <50%, <75%, >=75%
+
+    /** Share of the carved memory not holding live objects. */
+    double fragmentation() const { return slots ? 1.0 - double(live) / slots : 0.0; }
+
+    void print(FILE* out = stdout) const {
+        fprintf(out, "slabs %zu (%zu KiB), slots %zu, live %zu, free in magazines %zu, in depot %zu, "
+                     "fragmentation %.1f%%\n",
+                slabs, slabs * SLAB / 1024, slots, live, cached, depot, 100 * fragmentation());
+        fprintf(out, "slabs by live share: 0%% %zu, <25%% %zu, <50%% %zu, <75%% %zu, >=75%% %zu\n", histogram[0],
+                histogram[1], histogram[2], histogram[3], histogram[4]);
+    }
+};
+
+namespace detail {
+
+struct FreeNode {
+    FreeNode* next;
+};
+
+struct Magazine;
+
+// State shared by a pool and the magazines of the threads that used it
+struct Core {
+    // a free slot holds a FreeNode: slots are rounded up to its alignment too (sizeof(T) == 9 would misalign it)
+    Core(size_t size, size_t align)
+        : slot(round_up(std::max(size, sizeof(FreeNode)), std::max(align, alignof(FreeNode)))) {}
+
+    static size_t round_up(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+    ~Core() {
+        for (void* s : slabs)
+            free(s);
+    }
+
+    const size_t slot;
+    std::mutex mutex;
+    std::vector<FreeNode*> depot;        // lists of free objects, BATCH long except after a thread exit
+    std::vector<void*> slabs;
+    char* bump = nullptr;                // uncarved rest of the last slab
+    char* bump_end = nullptr;
+    std::vector<Magazine*> magazines;    // of live threads, for stats
+    int64_t live_of_exited = 0;          // created - destroyed by threads that are gone
+    std::atomic<bool> alive{true};       // false once the ObjectPool is destroyed
+
+    // under mutex: up to BATCH objects as a list, from the depot or newly carved
+    FreeNode* take_batch() {
+        if (!depot.empty()) {
+            FreeNode* list = depot.back();
+            depot.pop_back();
+            return list;
+        }
+        FreeNode* list = nullptr;
+        for (size_t i = 0; i < BATCH; i++) {
+            if (bump + slot > bump_end) {
+                void* s = aligned_alloc(SLAB, SLAB);
+                if (!s)
+                    throw std::bad_alloc();
+                slabs.push_back(s);
+                bump = (char*)s;
+                bump_end = bump + SLAB;
+            }
+            FreeNode* n = (FreeNode*)bump;
+            bump += slot;
+            n->next = list;
+            list = n;
+        }
+        return list;
+    }
+};
+
+// One thread's free objects of one pool
+struct Magazine {
+    explicit Magazine(std::shared_ptr<Core> c) : core(std::move(c)) {
+        std::lock_guard<std::mutex> lock(core->mutex);
+        core->magazines.push_back(this);
+    }
+
+    ~Magazine() {   // thread exit: everything back to the depot
+        std::lock_guard<std::mutex> lock(core->mutex);
+        while (n > 0)
+            core->depot.push_back(unlink(std::min(n, BATCH)));
+        auto& m = core->magazines;
+        m.erase(std::remove(m.begin(), m.end(), this), m.end());
+        core->live_of_exited += int64_t(created) - int64_t(destroyed);
+    }
+
+    void* pop() {
+        if (n == 0) {
+            std::lock_guard<std::mutex> lock(core->mutex);
+            for (FreeNode* list = core->take_batch(); list; list = list->next)
+                items[n++] = list;
+        }
+        created++;
+        return items[--n];
+    }
+
+    void push(void* p) {
+        if (n == 2 * BATCH) {
+            FreeNode* list = unlink(BATCH);
+            std::lock_guard<std::mutex> lock(core->mutex);
+            core->depot.push_back(list);
+        }
+        destroyed++;
+        items[n++] = p;
+    }
+
+    // the last k items as a list
+    FreeNode* unlink(size_t k) {
+        FreeNode* list = nullptr;
+        for (size_t i = 0; i < k; i++) {
+            FreeNode* node = (FreeNode*)items[--n];
+            node->next = list;
+            list = node;
+        }
+        return list;
+    }
+
+    std::shared_ptr<Core> core;
+    void* items[2 * BATCH];
+    size_t n = 0;
+    size_t created = 0, destroyed = 0;
+};
+
+// The magazines of the calling thread, one per live pool it used; the last one found is checked first.
+struct ThreadMagazines {
+    std::vector<std::unique_ptr<Magazine>> all;
+    Magazine* last = nullptr;
+
+    ~ThreadMagazines() { destroyed() = true; }
+
+    Magazine& get(const std::shared_ptr<Core>& core) {
+        if (last && last->core == core)
+            return *last;
+        drop_dead();
+        for (auto& m : all) {
+            if (m->core == core)
+                return *(last = m.get());
+        }
+        all.push_back(std::make_unique<Magazine>(core));
+        return *(last = all.back().get());
+    }
+
+    // the magazines of destroyed pools give their objects back and release the core
+    void drop_dead() {
+        last = nullptr;
+        all.erase(std::remove_if(all.begin(), all.end(),
+                                 [](const std::unique_ptr<Magazine>& m) {
+                                     return !m->core->alive.load(std::memory_order_relaxed);
+                                 }),
+                  all.end());
+    }
+
+    // a trivially destructible flag: pools destroyed after the thread's magazines (static pools in the main
+    // thread) must not touch them
+    static bool& destroyed() {
+        static thread_local bool d = false;
+        return d;
+    }
+};
+
+inline ThreadMagazines& thread_magazines() {
+    static thread_local ThreadMagazines t;
+    return t;
+}
+
+} // namespace detail
+
+/**
+ * Pool of T, a replacement of new T / delete for many same-sized objects. Thread-safe: objects can be
+ * destroyed by another thread than the one that created them.
+ */
+template <class T>
+class ObjectPool {
+public:
+    ObjectPool() : core_(std::make_shared<detail::Core>(sizeof(T), alignof(T))) {
+        static_assert(alignof(T) <= SLAB, "alignment larger than a slab");
+        static_assert(sizeof(T) <= SLAB, "object larger than a slab");   // an object never spans slabs
+    }
+
+    /** Objects still live are not destroyed; their memory goes away with the last thread that holds the pool. */
+    ~ObjectPool() {
+        core_->alive.store(false, std::memory_order_relaxed);
+        if (!detail::ThreadMagazines::destroyed())
+            detail::thread_magazines().drop_dead();
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <class... Args>
+    T* create(Args&&... args) {
+        void* p = allocate();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy(T* p) {
+        if (!p)
+            return;
+        p->~T();
+        deallocate(p);
+    }
+
+    /** Destroys n objects with one magazine lookup. */
+    void destroy_bulk(T* const* objs, size_t n) {
+        detail::Magazine& m = magazine();
+        for (size_t i = 0; i < n; i++) {
+            objs[i]->~T();
+            m.push(objs[i]);
+        }
+    }
+
+    /** Raw storage for one T. */
+    void* allocate() { return magazine().pop(); }
+    void deallocate(void* p) { magazine().push(p); }
+
+    /**
+     * Slab occupancy. Reads the magazines of other threads without synchronization: exact only
+     * when they do not use the pool at the moment.
+     */
+    Stats stats() const {
+        detail::Core& c = *core_;
+        std::lock_guard<std::mutex> lock(c.mutex);
+        Stats s;
+        s.slabs = c.slabs.size();
+        std::unordered_map<uintptr_t, size_t> free_in;   // slab -> free objects
+        int64_t live = c.live_of_exited;
+        for (detail::FreeNode* list : c.depot) {
+            for (; list; list = list->next, s.depot++)
+                free_in[(uintptr_t)list & ~(uintptr_t)(SLAB - 1)]++;
+        }
+        for (const detail::Magazine* m : c.magazines) {
+            live += int64_t(m->created) - int64_t(m->destroyed);
+            for (size_t i = 0; i < m->n; i++, s.cached++)
+                free_in[(uintptr_t)m->items[i] & ~(uintptr_t)(SLAB - 1)]++;
+        }
+        s.live = live > 0 ? live : 0;
+        for (void* slab : c.slabs) {
+            size_t carved = slab == c.slabs.back() ? (c.bump - (char*)slab) / c.slot : SLAB / c.slot;
+            s.slots += carved;
+            auto it = free_in.find((uintptr_t)slab);
+            size_t used = carved - (it == free_in.end() ? 0 : it->second);
+            double share = carved ? double(used) / carved : 0;
+            s.histogram[used == 0 ? 0 : share < 0.25 ? 1 : share < 0.5 ? 2 : share < 0.75 ? 3 : 4]++;
+        }
+        return s;
+    }
+
+private:
+    detail::Magazine& magazine() { return detail::thread_magazines().get(core_); }
+
+    std::shared_ptr<detail::Core> core_;
+};
+
+} // namespace pool
+
+#endif // OBJECT_POOL_HPP
@@ -0,0 +1,125 @@
+// Shotgun objects of ../5.c (new Shotgun(10) ... delete) from new/delete and from pool::ObjectPool
+// at 1..64 threads, then the fragmentation report of the pool after a random workload.
+//   g++ -O2 -std=c++17 -pthread pool_bench.cpp -o pool_bench && ./pool_bench [operations per thread = 4000000]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include "object_pool.hpp"
+
+// the hierarchy of 5.c without the output
+class Weapon {
+public:
+    virtual ~Weapon() = default;
+    virtual unsigned attack() = 0;
+};
+
+class Ammo {
+public:
+    unsigned ammo;
+    explicit Ammo(unsigned num) : ammo(num) {}
+};
+
+class Shotgun : public Ammo, public Weapon {
+public:
+    explicit Shotgun(unsigned num) : Ammo(num) {}
+    unsigned attack() override { return ammo ? --ammo : 0; }
+};
+
+static pool::ObjectPool<Shotgun> g_pool;
+
+struct NewDelete {
+    static Shotgun* create() { return new Shotgun(10); }
+    static void destroy(Shotgun* s) { delete s; }
+};
+
+struct Pooled {
+    static Shotgun* create() { return g_pool.create(10); }
+    static void destroy(Shotgun* s) { g_pool.destroy(s); }
+};
+
+// every thread keeps 1024 live objects and replaces a random one per operation
+template <class Alloc>
+static void churn(size_t ops, unsigned seed) {
+    std::vector<Shotgun*> live(1024);
+    for (auto& p : live)
+        p = Alloc::create();
+    std::mt19937 rng(seed);
+    unsigned sum = 0;
+    for (size_t i = 0; i < ops; i++) {
+        Shotgun*& p = live[rng() & 1023];
+        sum += p->attack();
+        Alloc::destroy(p);
+        p = Alloc::create();
+    }
+    for (Shotgun* p : live)
+        Alloc::destroy(p);
+    asm volatile("" : : "r"(sum));
+}
+
+template <class Alloc>
+static double run(int threads, size_t ops) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> ts;
+    for (int t = 0; t < threads; t++)
+        ts.emplace_back(churn<Alloc>, ops, t + 1);
+    for (auto& t : ts)
+        t.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return threads * ops / s / 1e6;
+}
+
+// a size that is not a multiple of the pointer size: the free-list links in the slots must stay aligned
+// (run under -fsanitize=undefined to see a misaligned FreeNode)
+struct Odd {
+    char c[9];
+};
+
+static void check_odd_size() {
+    pool::ObjectPool<Odd> odd;
+    std::vector<Odd*> objs(4 * pool::BATCH + 3);   // more than a magazine holds: lists go through the depot
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < objs.size(); i++) {
+            objs[i] = odd.create();
+            memset(objs[i]->c, int(i), sizeof(objs[i]->c));
+            if ((uintptr_t)objs[i] % alignof(void*) != 0) {
+                fprintf(stderr, "misaligned slot %p for sizeof(Odd) = %zu\n", (void*)objs[i], sizeof(Odd));
+                exit(1);
+            }
+        }
+        for (size_t i = 0; i < objs.size(); i++) {
+            if (objs[i]->c[8] != char(i)) {
+                fprintf(stderr, "slot %zu overwritten\n", i);
+                exit(1);
+            }
+            odd.destroy(objs[i]);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    check_odd_size();
+    size_t ops = argc > 1 ? atol(argv[1]) : 4000000;
+    printf("%8s %18s %18s   (M create+destroy/s)\n", "threads", "new/delete", "ObjectPool");
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        size_t per_thread = ops / threads;
+        double a = run<NewDelete>(threads, per_thread);
+        double b = run<Pooled>(threads, per_thread);
+        printf("%8d %18.1f %18.1f\n", threads, a, b);
+    }
+
+    // fragmentation: fill, free a random 90%, look at the slabs
+    std::vector<Shotgun*> objs(1 << 20);
+    for (auto& p : objs)
+        p = g_pool.create(10);
+    std::mt19937 rng(7);
+    std::shuffle(objs.begin(), objs.end(), rng);
+    g_pool.destroy_bulk(objs.data(), objs.size() * 9 / 10);
+    printf("\nafter 1M creates and 900K random destroys (sizeof(Shotgun) = %zu):\n", sizeof(Shotgun));
+    g_pool.stats().print();
+    g_pool.destroy_bulk(objs.data() + objs.size() * 9 / 10, objs.size() - objs.size() * 9 / 10);
+    return 0;
+}
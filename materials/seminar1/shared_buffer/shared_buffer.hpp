@@ -0,0 +1,170 @@
+// Reference-counted array with copy-on-write, the shared form of the `int* p` of ../6.c. See readme.md.
+//
+// Copies share one heap block (a header with the count and the size, then the elements); a copy is an atomic
+// increment instead of new[] + a loop. write() gives the caller its own block first if another SharedBuffer
+// still refers to it, so readers never see writes made through other copies. Spans are non-owning views.
+#ifndef SHARED_BUFFER_HPP
+#define SHARED_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cow {
+
+/** Non-owning view of n contiguous T (std::span of C++20, as far as used here). */
+template <class T>
+class Span {
+public:
+    Span() = default;
+    Span(T* p, size_t n) : p_(p), n_(n) {}
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(Span<U> o) : p_(o.data()), n_(o.size()) {}
+
+    T* data() const { return p_; }
+    size_t size() const { return n_; }
+    bool empty() const { return n_ == 0; }
+    T& operator[](size_t i) const { return p_[i]; }
+    T* begin() const { return p_; }
+    T* end() const { return p_ + n_; }
+    Span subspan(size_t offset, size_t count) const { return {p_ + offset, count}; }
+
+private:
+    T* p_ = nullptr;
+    size_t n_ = 0;
+};
+
+/**
+ * Array of T whose copies share the elements until one of them writes. Reading (const access, view()) never
+ * copies; write() copies the elements once if the block is shared and returns a mutable view of the own block.
+ * Like std::shared_ptr, different SharedBuffer objects may be used from different threads concurrently even if
+ * they share a block; one object is not synchronized.
+ */
+template <class T>
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+
+    explicit SharedBuffer(size_t n, const T& value = T())
+        : h_(Header::build(n, [&](T* d) { std::uninitialized_fill_n(d, n, value); })) {}
+
+    SharedBuffer(std::initializer_list<T> init)
+        : h_(Header::build(init.size(), [&](T* d) { std::uninitialized_copy(init.begin(), init.end(), d); })) {}
+
+    SharedBuffer(const SharedBuffer& o) noexcept : h_(o.h_) {
+        if (h_)
+            h_->refs.fetch_add(1, std::memory_order_relaxed);   // o holds a reference, the block cannot go away
+    }
+
+    SharedBuffer(SharedBuffer&& o) noexcept : h_(std::exchange(o.h_, nullptr)) {}
+
+    // any size: the block is replaced, not written into; no count traffic if both already share it
+    SharedBuffer& operator=(const SharedBuffer& o) noexcept {
+        if (h_ != o.h_) {
+            if (o.h_)
+                o.h_->refs.fetch_add(1, std::memory_order_relaxed);
+            release(std::exchange(h_, o.h_));
+        }
+        return *this;
+    }
+
+    SharedBuffer& operator=(SharedBuffer&& o) noexcept {
+        if (this != &o)
+            release(std::exchange(h_, std::exchange(o.h_, nullptr)));
+        return *this;
+    }
+
+    ~SharedBuffer() { release(h_); }
+
+    size_t size() const { return h_ ? h_->size : 0; }
+    bool empty() const { return size() == 0; }
+    const T* data() const { return h_ ? h_->data() : nullptr; }
+    const T& operator[](size_t i) const { return h_->data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+    /** Read-only view, valid while this buffer refers to the same block. */
+    Span<const T> view() const { return {data(), size()}; }
+
+    /** Number of SharedBuffer objects sharing the block (0 if empty). */
+    size_t use_count() const { return h_ ? h_->refs.load(std::memory_order_acquire) : 0; }
+
+    /** True if no other SharedBuffer refers to the block: write() will not copy. */
+    bool unique() const { return use_count() <= 1; }
+
+    /**
+     * Mutable view of the elements, copied first if the block is shared. The view is valid until this buffer is
+     * copied, assigned or destroyed; writing through it after a copy would change the copy too.
+     */
+    Span<T> write() {
+        if (h_ && h_->refs.load(std::memory_order_acquire) != 1)
+            detach();
+        return {h_ ? h_->data() : nullptr, size()};
+    }
+
+    /** write()[i] = value. */
+    void set(size_t i, const T& value) { write()[i] = value; }
+
+    void swap(SharedBuffer& o) noexcept { std::swap(h_, o.h_); }
+
+private:
+    // the elements follow the header in the same allocation
+    struct Header {
+        std::atomic<size_t> refs{1};
+        size_t size = 0;   // constructed elements
+
+        static constexpr size_t data_offset() { return (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T); }
+
+        T* data() { return reinterpret_cast<T*>(reinterpret_cast<char*>(this) + data_offset()); }
+
+        static constexpr std::align_val_t ALIGN{alignof(T) > alignof(size_t) ? alignof(T) : alignof(size_t)};
+
+        // a block of n elements constructed by construct(data); nothing leaks if it throws
+        template <class F>
+        static Header* build(size_t n, F construct) {
+            Header* h = new (::operator new(data_offset() + n * sizeof(T), ALIGN)) Header;
+            try {
+                construct(h->data());
+            } catch (...) {
+                destroy(h);
+                throw;
+            }
+            h->size = n;
+            return h;
+        }
+
+        static void destroy(Header* h) noexcept {
+            std::destroy_n(h->data(), h->size);
+            h->~Header();
+            ::operator delete(h, ALIGN);
+        }
+    };
+
+    // the last owner destroys: acq_rel orders every owner's reads and writes before the destruction
+    static void release(Header* h) noexcept {
+        if (h && h->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Header::destroy(h);
+    }
+
+    void detach() {
+        const T* src = h_->data();
+        Header* h = Header::build(h_->size, [&](T* d) { std::uninitialized_copy_n(src, h_->size, d); });
+        release(std::exchange(h_, h));
+    }
+
+    Header* h_ = nullptr;
+};
+
+template <class T>
+void swap(SharedBuffer<T>& a, SharedBuffer<T>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace cow
+
+#endif // SHARED_BUFFER_HPP
@@ -0,0 +1,85 @@
+// A of ../6.c passed around read-mostly: with the deep copy of 6.c (new int[a] and a loop per copy) and with
+// cow::SharedBuffer (a copy is a reference count increment, a write after sharing copies once).
+//   g++ -O2 -std=c++17 shared_buffer_bench.cpp -o shared_buffer_bench && ./shared_buffer_bench
+#include <algorithm>
+#include <vector>
+#include "shared_buffer.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+// A of 6.c with the size mismatch of its assignment fixed (the buffer is reallocated)
+class DeepA {
+public:
+    int a;
+    int b = 0;
+    int* p;
+
+    DeepA(int a, int b) : a(a), b(b), p(new int[a]()) {}
+    DeepA(const DeepA& o) : a(o.a), b(o.b), p(new int[o.a]) { std::copy(o.p, o.p + a, p); }
+    DeepA& operator=(const DeepA& o) {
+        if (this != &o) {
+            if (a != o.a) {
+                delete[] p;
+                p = new int[o.a];
+                a = o.a;
+            }
+            std::copy(o.p, o.p + a, p);
+            b = o.b;
+        }
+        return *this;
+    }
+    ~DeepA() { delete[] p; }
+
+    int get(int i) const { return p[i]; }
+    void set(int i, int v) { p[i] = v; }
+};
+
+// the same with a shared p; the defaulted copies share it
+class SharedA {
+public:
+    int a;
+    int b = 0;
+    cow::SharedBuffer<int> p;
+
+    SharedA(int a, int b) : a(a), b(b), p(a) {}
+
+    int get(int i) const { return p[i]; }
+    void set(int i, int v) { p.set(i, v); }
+};
+
+// copy and read one element: passing the object by value
+template <class A>
+static void bm_copy(bench::State& st) {
+    int n = st.arg();
+    A src(n, 1);
+    while (st.keep_running()) {
+        A copy = src;
+        bench::do_not_optimize(copy.get(n / 2));
+    }
+}
+
+// 64 readers hold snapshots of the source: every operation hands the current source to one reader, who reads an
+// element; every 100th operation the source is changed (in place for DeepA, one copy of the block for SharedA)
+template <class A>
+static void bm_read_mostly(bench::State& st) {
+    int n = st.arg();
+    A src(n, 1);
+    std::vector<A> readers(64, src);
+    unsigned op = 0, sum = 0;
+    while (st.keep_running()) {
+        for (int k = 0; k < 100; k++, op++) {
+            A& r = readers[op % readers.size()];
+            r = src;
+            sum += r.get(op % n);
+        }
+        src.set(op % n, op);
+    }
+    bench::do_not_optimize(sum);
+    st.set_items_per_iteration(100);
+}
+
+#define SIZES 4, 64, 1024, 65536
+BENCH(bm_copy<DeepA>, SIZES);
+BENCH(bm_copy<SharedA>, SIZES);
+BENCH(bm_read_mostly<DeepA>, SIZES);
+BENCH(bm_read_mostly<SharedA>, SIZES);
+BENCH_MAIN();
@@ -0,0 +1,365 @@
+// Vector with N elements of inline capacity, for the arrays of ../6.c that are nearly always small. See readme.md.
+//
+// Up to N elements live in the object itself, no allocation; beyond that the elements move to the heap (from the
+// allocator) and grow by doubling like std::vector. Types that are trivially relocatable are moved to the new
+// storage with one memcpy, others with move constructors (or copies if the move may throw, as std::vector does).
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace smallvec {
+
+/**
+ * True if moving a T to another address and not destroying the source is the same as copying its bytes.
+ * Holds for trivially copyable types and for most classes that own memory through a pointer (std::unique_ptr,
+ * std::vector, std::shared_ptr); not for types that point into themselves (libstdc++ std::string, std::list).
+ * Specialize it for such classes of your own.
+ */
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T, class D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : std::true_type {};
+
+template <class T, size_t N, class Alloc = std::allocator<T>>
+class SmallVector : private Alloc {   // private base: an empty allocator takes no space
+    using Traits = std::allocator_traits<Alloc>;
+    static_assert(std::is_same_v<typename Traits::value_type, T>, "Alloc::value_type must be T");
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t INLINE_CAPACITY = N;
+
+    /** Relocating the elements cannot throw, so neither can moves of a SmallVector between equal allocators. */
+    static constexpr bool NOTHROW_RELOCATE =
+        is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible_v<T>;
+
+    SmallVector() noexcept(noexcept(Alloc())) : Alloc() {}
+    explicit SmallVector(const Alloc& a) noexcept : Alloc(a) {}
+
+    explicit SmallVector(size_t n, const Alloc& a = Alloc()) : Alloc(a) { resize(n); }
+    SmallVector(size_t n, const T& value, const Alloc& a = Alloc()) : Alloc(a) { resize(n, value); }
+    SmallVector(std::initializer_list<T> init, const Alloc& a = Alloc()) : Alloc(a) { assign(init.begin(), init.end()); }
+
+    template <class It, class = typename std::iterator_traits<It>::iterator_category>
+    SmallVector(It first, It last, const Alloc& a = Alloc()) : Alloc(a) {
+        assign(first, last);
+    }
+
+    SmallVector(const SmallVector& o) : Alloc(Traits::select_on_container_copy_construction(o.alloc())) {
+        assign(o.begin(), o.end());
+    }
+
+    SmallVector(SmallVector&& o) noexcept(NOTHROW_RELOCATE) : Alloc(std::move(o.alloc())) {
+        take(o);
+    }
+
+    SmallVector& operator=(const SmallVector& o) {
+        if (this != &o) {
+            if constexpr (Traits::propagate_on_container_copy_assignment::value) {
+                if (alloc() != o.alloc()) {
+                    clear();
+                    release();
+                }
+                alloc() = o.alloc();
+            }
+            assign(o.begin(), o.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& o) noexcept(NOTHROW_RELOCATE &&
+                                                     (Traits::propagate_on_container_move_assignment::value ||
+                                                      Traits::is_always_equal::value)) {
+        if (this == &o)
+            return *this;
+        clear();
+        if (Traits::propagate_on_container_move_assignment::value || alloc() == o.alloc()) {
+            release();
+            if constexpr (Traits::propagate_on_container_move_assignment::value)
+                alloc() = std::move(o.alloc());
+            take(o);
+        } else {
+            // the heap block of o cannot be freed by our allocator: move the elements one by one
+            reserve(o.size());
+            for (T& x : o)
+                emplace_back(std::move(x));
+            o.clear();
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    ~SmallVector() {
+        destroy(begin_, begin_ + size_);
+        release();
+    }
+
+    allocator_type get_allocator() const { return alloc(); }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return cap_; }
+    bool empty() const { return size_ == 0; }
+    /** True while the elements are in the inline buffer. */
+    bool is_inline() const { return begin_ == inline_data(); }
+
+    T* data() { return begin_; }
+    const T* data() const { return begin_; }
+    iterator begin() { return begin_; }
+    iterator end() { return begin_ + size_; }
+    const_iterator begin() const { return begin_; }
+    const_iterator end() const { return begin_ + size_; }
+    T& operator[](size_t i) { return begin_[i]; }
+    const T& operator[](size_t i) const { return begin_[i]; }
+    T& front() { return begin_[0]; }
+    const T& front() const { return begin_[0]; }
+    T& back() { return begin_[size_ - 1]; }
+    const T& back() const { return begin_[size_ - 1]; }
+
+    T& at(size_t i) {
+        if (i >= size_)
+            throw std::out_of_range("SmallVector::at");
+        return begin_[i];
+    }
+    const T& at(size_t i) const { return const_cast<SmallVector*>(this)->at(i); }
+
+    template <class It>
+    void assign(It first, It last) {
+        clear();
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<It>::iterator_category>)
+            reserve(std::distance(first, last));
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    void reserve(size_t n) {
+        if (n > cap_)
+            reallocate(n);
+    }
+
+    /** Moves the elements back inline if they fit, otherwise to a heap block of exactly size() elements. */
+    void shrink_to_fit() {
+        if (!is_inline() && size_ < cap_)
+            reallocate(size_);
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == cap_)
+            return grow_emplace_back(std::forward<Args>(args)...);
+        Traits::construct(alloc(), begin_ + size_, std::forward<Args>(args)...);
+        return begin_[size_++];
+    }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    void pop_back() { Traits::destroy(alloc(), begin_ + --size_); }
+
+    template <class... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        size_t i = pos - begin_;
+        emplace_back(std::forward<Args>(args)...);   // may reallocate: positions, not pointers
+        std::rotate(begin_ + i, begin_ + size_ - 1, begin_ + size_);
+        return begin_ + i;
+    }
+
+    iterator insert(const_iterator pos, const T& v) { return emplace(pos, v); }
+    iterator insert(const_iterator pos, T&& v) { return emplace(pos, std::move(v)); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T* f = begin_ + (first - begin_);
+        T* l = begin_ + (last - begin_);
+        if (f != l) {
+            T* new_end = std::move(l, end(), f);
+            destroy(new_end, end());
+            size_ = new_end - begin_;
+        }
+        return f;
+    }
+
+    void clear() {
+        destroy(begin_, begin_ + size_);
+        size_ = 0;
+    }
+
+    void resize(size_t n) { resize_with(n, [&](T* p) { Traits::construct(alloc(), p); }); }
+    void resize(size_t n, const T& value) {
+        if (n > cap_ && &value >= begin_ && &value < end()) {   // value is ours and moves with the reallocation
+            T copy(value);
+            resize(n, copy);
+            return;
+        }
+        resize_with(n, [&](T* p) { Traits::construct(alloc(), p, value); });
+    }
+
+    void swap(SmallVector& o) noexcept(NOTHROW_RELOCATE) {
+        if (!is_inline() && !o.is_inline() &&
+            (Traits::propagate_on_container_swap::value || alloc() == o.alloc())) {
+            std::swap(begin_, o.begin_);
+            std::swap(size_, o.size_);
+            std::swap(cap_, o.cap_);
+            if constexpr (Traits::propagate_on_container_swap::value)
+                std::swap(alloc(), o.alloc());
+            return;
+        }
+        SmallVector tmp(std::move(o));
+        o = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend bool operator==(const SmallVector& a, const SmallVector& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const SmallVector& a, const SmallVector& b) { return !(a == b); }
+
+private:
+    Alloc& alloc() { return *this; }
+    const Alloc& alloc() const { return *this; }
+
+    T* inline_data() { return reinterpret_cast<T*>(inline_); }
+    const T* inline_data() const { return reinterpret_cast<const T*>(inline_); }
+
+    void destroy(T* first, T* last) {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (; first != last; ++first)
+                Traits::destroy(alloc(), first);
+    }
+
+    // n elements from src to the uninitialized dst; the sources are left destroyed
+    void relocate(T* src, size_t n, T* dst) {
+        if constexpr (is_trivially_relocatable<T>::value) {
+            if (n)
+                memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < n; i++)
+                    Traits::construct(alloc(), dst + i, std::move_if_noexcept(src[i]));
+            } catch (...) {
+                destroy(dst, dst + i);   // the sources are intact: a throwing move is never used
+                throw;
+            }
+            destroy(src, src + n);
+        }
+    }
+
+    // frees the heap block, if any, and goes back to the empty inline buffer; the elements are already gone
+    void release() {
+        if (!is_inline())
+            Traits::deallocate(alloc(), begin_, cap_);
+        begin_ = inline_data();
+        cap_ = N;
+    }
+
+    void reallocate(size_t n) {
+        T* p = n <= N ? inline_data() : Traits::allocate(alloc(), n);
+        if (p == begin_)
+            return;
+        try {
+            relocate(begin_, size_, p);
+        } catch (...) {
+            if (p != inline_data())
+                Traits::deallocate(alloc(), p, n);
+            throw;
+        }
+        if (!is_inline())
+            Traits::deallocate(alloc(), begin_, cap_);
+        begin_ = p;
+        cap_ = std::max(n, N);
+    }
+
+    size_t next_capacity(size_t needed) const { return std::max({needed, 2 * cap_, size_t(1)}); }
+
+    // the new element is built in the new block before the old ones move: args may refer to one of them
+    template <class... Args>
+    __attribute__((noinline)) T& grow_emplace_back(Args&&... args) {
+        size_t n = next_capacity(size_ + 1);
+        T* p = Traits::allocate(alloc(), n);
+        try {
+            Traits::construct(alloc(), p + size_, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(alloc(), p, n);
+            throw;
+        }
+        try {
+            relocate(begin_, size_, p);
+        } catch (...) {
+            Traits::destroy(alloc(), p + size_);
+            Traits::deallocate(alloc(), p, n);
+            throw;
+        }
+        if (!is_inline())
+            Traits::deallocate(alloc(), begin_, cap_);
+        begin_ = p;
+        cap_ = n;
+        return begin_[size_++];
+    }
+
+    template <class Construct>
+    void resize_with(size_t n, Construct construct) {
+        if (n <= size_) {
+            destroy(begin_ + n, end());
+            size_ = n;
+            return;
+        }
+        reserve(n);
+        for (; size_ < n; size_++)
+            construct(begin_ + size_);
+    }
+
+    // the elements of o (o is moved-from, our elements are gone and our block released)
+    void take(SmallVector& o) {
+        if (o.is_inline()) {
+            relocate(o.begin_, o.size_, begin_);
+        } else {
+            begin_ = o.begin_;
+            cap_ = o.cap_;
+            o.begin_ = o.inline_data();
+            o.cap_ = N;
+        }
+        size_ = o.size_;
+        o.size_ = 0;
+    }
+
+    T* begin_ = inline_data();
+    size_t size_ = 0;
+    size_t cap_ = N;
+    alignas(T) unsigned char inline_[N ? N * sizeof(T) : 1];
+};
+
+template <class T, size_t N, class A>
+void swap(SmallVector<T, N, A>& a, SmallVector<T, N, A>& b) noexcept(noexcept(a.swap(b))) {
+    a.swap(b);
+}
+
+} // namespace smallvec
+
+#endif // SMALL_VECTOR_HPP
@@ -0,0 +1,129 @@
+// std::vector against smallvec::SmallVector<T, 8> at the sizes the arrays of ../6.c usually have (1..8 elements),
+// with a counting allocator, so the heap allocations per operation are printed beside the times.
+//   g++ -O2 -std=c++17 small_vector_bench.cpp -o small_vector_bench && ./small_vector_bench
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "small_vector.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+static size_t g_allocs = 0;
+
+// std::allocator that counts allocate calls
+template <class T>
+struct Counting : std::allocator<T> {
+    template <class U>
+    struct rebind {
+        using other = Counting<U>;
+    };
+    Counting() = default;
+    template <class U>
+    Counting(const Counting<U>&) {}
+    T* allocate(size_t n) {
+        g_allocs++;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+template <class T>
+using Std = std::vector<T, Counting<T>>;
+template <class T>
+using Small = smallvec::SmallVector<T, 8, Counting<T>>;
+
+static std::vector<int> small_sizes(size_t n) {
+    std::mt19937 rng(1);
+    std::vector<int> v(n);
+    for (int& x : v)
+        x = 1 + rng() % 8;
+    return v;
+}
+
+// build an array of k ints by push_back, sum it, destroy it
+template <class V>
+static void bm_build(bench::State& st) {
+    std::vector<int> sizes = small_sizes(1024);
+    size_t i = 0;
+    while (st.keep_running()) {
+        V v;
+        for (int k = 0; k < sizes[i]; k++)
+            v.push_back(k);
+        int s = 0;
+        for (int x : v)
+            s += x;
+        bench::do_not_optimize(s);
+        i = (i + 1) % sizes.size();
+    }
+}
+
+// 10^6 objects holding an array of 1..8 ints, created in random order, then summed: with std::vector each
+// array is a separate heap block, SmallVector keeps it in the object
+template <class V>
+static void bm_sum_many(bench::State& st) {
+    std::vector<int> sizes = small_sizes(1000000);
+    std::vector<V> objs(sizes.size());
+    std::mt19937 rng(2);
+    std::vector<size_t> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);   // heap blocks are not in the order of the objects
+    for (size_t i : order)
+        for (int k = 0; k < sizes[i]; k++)
+            objs[i].push_back(k);
+    while (st.keep_running()) {
+        long s = 0;
+        for (const V& v : objs)
+            for (int x : v)
+                s += x;
+        bench::do_not_optimize(s);
+    }
+    st.set_items_per_iteration(objs.size());
+}
+
+// growth of an array of unique_ptr past the inline capacity: std::vector moves the pointers one by one (and nulls
+// the sources, then runs their destructors), SmallVector copies the bytes
+template <class V>
+static void bm_grow_unique_ptr(bench::State& st) {
+    std::vector<std::unique_ptr<int>> values;
+    for (long i = 0; i < st.arg(); i++)
+        values.emplace_back(new int(i));
+    while (st.keep_running()) {
+        V v;
+        for (auto& p : values)
+            v.push_back(std::move(p));
+        for (size_t i = 0; i < values.size(); i++)
+            values[i] = std::move(v[i]);
+        bench::do_not_optimize(v);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+BENCH(bm_build<Std<int>>);
+BENCH(bm_build<Small<int>>);
+BENCH(bm_sum_many<Std<int>>);
+BENCH(bm_sum_many<Small<int>>);
+BENCH(bm_grow_unique_ptr<Std<std::unique_ptr<int>>>, 64, 4096);
+BENCH(bm_grow_unique_ptr<Small<std::unique_ptr<int>>>, 64, 4096);
+
+int main(int argc, char** argv) {
+    int r = bench::run_all(argc, argv);
+    // allocations per operation, counted outside the timed runs
+    std::vector<int> sizes = small_sizes(1024);
+    size_t before = g_allocs;
+    for (int n : sizes) {
+        Std<int> v;
+        for (int k = 0; k < n; k++)
+            v.push_back(k);
+    }
+    size_t std_allocs = g_allocs - before;
+    before = g_allocs;
+    for (int n : sizes) {
+        Small<int> v;
+        for (int k = 0; k < n; k++)
+            v.push_back(k);
+    }
+    printf("\nheap allocations per array of 1..8 ints built by push_back: std::vector %.2f, SmallVector %.2f\n",
+           double(std_allocs) / sizes.size(), double(g_allocs - before) / sizes.size());
+    return r;
+}
@@ -0,0 +1,365 @@
+// Header-only microbenchmark runner: warmup, iteration count calibration, CPU pinning,
+// outlier rejection, confidence intervals, optimization barriers and JSON output.
+// See readme.md in this directory.
+//
+//     static void bm_a(bench::State& st) {
+//         while (st.keep_running())
+//             bench::do_not_optimize(a());
+//     }
+//     BENCH(bm_a);
+//     BENCH(bm_sort, 1024, 65536);   // one benchmark per argument, st.arg()
+//     BENCH_MAIN();
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+/**
+ * Makes the compiler assume that value is read (and, for the non-const
+ * overload, modified), so the computation producing it is not eliminated.
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// Forces pending writes to memory to be considered observable.
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+typedef std::chrono::steady_clock Clock;
+
+class State {
+public:
+    State(uint64_t iterations, long arg) : iterations_(iterations), left_(iterations), arg_(arg) {}
+
+    /**
+     * Loop condition of the benchmark body. Timing starts at the first call and
+     * stops when it returns false.
+     */
+    bool keep_running() {
+        if (left_ == iterations_ && !started_) {
+            started_ = true;
+            start_ = Clock::now();
+        }
+        if (left_ == 0) {
+            if (!paused_)
+                elapsed_ += Clock::now() - start_;
+            return false;
+        }
+        left_--;
+        return true;
+    }
+
+    // Excludes per-iteration setup from the measurement.
+    void pause_timing() {
+        elapsed_ += Clock::now() - start_;
+        paused_ = true;
+    }
+    void resume_timing() {
+        paused_ = false;
+        start_ = Clock::now();
+    }
+
+    long arg() const { return arg_; }
+    uint64_t iterations() const { return iterations_; }
+    // Throughput reporting, e.g. elements or bytes processed by one iteration.
+    void set_items_per_iteration(double items) { items_ = items; }
+
+    double seconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+    double items_per_iteration() const { return items_; }
+
+private:
+    uint64_t iterations_;
+    uint64_t left_;
+    long arg_;
+    bool started_ = false;
+    bool paused_ = false;
+    double items_ = 0;
+    Clock::time_point start_;
+    Clock::duration elapsed_ = Clock::duration::zero();
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<void(State&)> fn;
+    long arg;
+};
+
+inline std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*fn)(State&), std::initializer_list<long> args = {}) {
+        if (args.size() == 0)
+            registry().push_back(Benchmark{name, fn, 0});
+        for (long a : args)
+            registry().push_back(Benchmark{std::string(name) + "/" + std::to_string(a), fn, a});
+    }
+};
+
+struct Options {
+    std::string filter;
+    double min_time = 0.5;      // seconds of measurement per benchmark
+    double warmup = 0.1;        // seconds
+    int samples = 20;           // timed batches
+    int cpu = -1;               // pin to this CPU, -1 -- do not pin
+    std::string json;           // output file, empty -- no JSON
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;    // per sample
+    int samples = 0;
+    int outliers = 0;
+    double mean = 0, median = 0, stddev = 0, min = 0, ci_low = 0, ci_high = 0;   // ns per iteration
+    double items_per_second = 0;
+};
+
+// Two-sided 95% quantile of Student's t distribution.
+inline double t95(int df) {
+    static const double table[] = {0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+                                   2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+                                   2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+                                   2.048, 2.045, 2.042};
+    if (df <= 0)
+        return 0;
+    return df <= 30 ? table[df] : 1.96;
+}
+
+inline double run_once(const Benchmark& b, uint64_t iterations, double* items) {
+    State st(iterations, b.arg);
+    b.fn(st);
+    if (items)
+        *items = st.items_per_iteration();
+    return st.seconds();
+}
+
+/**
+ * Drops samples outside Tukey's fences [Q1 - 1.5 IQR, Q3 + 1.5 IQR]
+ * (interrupts, frequency changes, page faults), returns the number dropped.
+ */
+inline int reject_outliers(std::vector<double>& v) {
+    if (v.size() < 4)
+        return 0;
+    std::vector<double> s = v;
+    std::sort(s.begin(), s.end());
+    double q1 = s[s.size() / 4], q3 = s[(3 * s.size()) / 4];
+    double lo = q1 - 1.5 * (q3 - q1), hi = q3 + 1.5 * (q3 - q1);
+    size_t before = v.size();
+    v.erase(std::remove_if(v.begin(), v.end(), [&](double x) { return x < lo || x > hi; }), v.end());
+    return (int)(before - v.size());
+}
+
+inline Result measure(const Benchmark& b, const Options& opt) {
+    // warmup: caches, branch predictors, page faults, CPU frequency
+    auto w0 = Clock::now();
+    uint64_t n = 1;
+    while (std::chrono::duration<double>(Clock::now() - w0).count() < opt.warmup) {
+        run_once(b, n, nullptr);
+        n = std::min<uint64_t>(n * 2, 1ULL << 40);
+    }
+
+    // calibration: one sample should take min_time / samples
+    double target = opt.min_time / opt.samples;
+    n = 1;
+    while (true) {
+        double t = run_once(b, n, nullptr);
+        if (t >= target || n >= (1ULL << 40))
+            break;
+        double grow = t > 0 ? std::min(10.0, std::max(1.5, 1.2 * target / t)) : 10.0;
+        n = (uint64_t)std::ceil(n * grow);
+    }
+
+    Result r;
+    r.name = b.name;
+    r.iterations = n;
+    std::vector<double> ns;
+    double items = 0;
+    for (int i = 0; i < opt.samples; i++)
+        ns.push_back(run_once(b, n, &items) * 1e9 / n);
+    r.outliers = reject_outliers(ns);
+    r.samples = (int)ns.size();
+
+    std::sort(ns.begin(), ns.end());
+    double sum = 0;
+    for (double x : ns)
+        sum += x;
+    r.mean = sum / ns.size();
+    r.median = ns.size() % 2 ? ns[ns.size() / 2] : (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]) / 2;
+    r.min = ns.front();
+    double sq = 0;
+    for (double x : ns)
+        sq += (x - r.mean) * (x - r.mean);
+    r.stddev = ns.size() > 1 ? std::sqrt(sq / (ns.size() - 1)) : 0;
+    double half = t95((int)ns.size() - 1) * r.stddev / std::sqrt((double)ns.size());
+    r.ci_low = r.mean - half;
+    r.ci_high = r.mean + half;
+    if (items > 0)
+        r.items_per_second = items * 1e9 / r.mean;
+    return r;
+}
+
+inline bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+inline std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if ((unsigned char)c >= 0x20)
+            out += c;
+    }
+    return out;
+}
+
+inline std::string cpu_model() {
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    char line[512];
+    std::string model = "unknown";
+    while (f && fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "model name", 10) == 0) {
+            const char* p = strchr(line, ':');
+            if (p) {
+                model = p + 2;
+                model.erase(model.find_last_not_of("\n") + 1);
+            }
+            break;
+        }
+    }
+    if (f)
+        fclose(f);
+    return model;
+}
+
+/**
+ * JSON report. The context identifies the run for the history store (BENCH_COMMIT
+ * is taken from the environment, the Makefile sets it from git).
+ */
+inline void write_json(const std::string& path, const char* program, const Options& opt,
+                       const std::vector<Result>& results) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) {
+        perror(path.c_str());
+        return;
+    }
+    char host[256] = "unknown";
+#ifdef __linux__
+    gethostname(host, sizeof(host));
+#endif
+    const char* commit = getenv("BENCH_COMMIT");
+    fprintf(f, "{\n  \"context\": {\"program\": \"%s\", \"date\": %lld, \"host\": \"%s\", "
+               "\"cpu\": \"%s\", \"compiler\": \"%s\", \"commit\": \"%s\", \"pinned_cpu\": %d},\n"
+               "  \"benchmarks\": [\n",
+            json_escape(program).c_str(), (long long)time(nullptr), json_escape(host).c_str(),
+            json_escape(cpu_model()).c_str(), json_escape(__VERSION__).c_str(),
+            json_escape(commit ? commit : "").c_str(), opt.cpu);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %d, \"outliers\": %d, "
+                   "\"mean_ns\": %.4f, \"median_ns\": %.4f, \"stddev_ns\": %.4f, \"min_ns\": %.4f, "
+                   "\"ci95_low_ns\": %.4f, \"ci95_high_ns\": %.4f, \"items_per_second\": %.1f}%s\n",
+                json_escape(r.name).c_str(), (unsigned long long)r.iterations, r.samples, r.outliers,
+                r.mean, r.median, r.stddev, r.min, r.ci_low, r.ci_high, r.items_per_second,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+}
+
+inline int run_all(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strncmp(a, "--filter=", 9) == 0)
+            opt.filter = a + 9;
+        else if (strncmp(a, "--min-time=", 11) == 0)
+            opt.min_time = atof(a + 11);
+        else if (strncmp(a, "--warmup=", 9) == 0)
+            opt.warmup = atof(a + 9);
+        else if (strncmp(a, "--samples=", 10) == 0)
+            opt.samples = std::max(2, atoi(a + 10));
+        else if (strncmp(a, "--cpu=", 6) == 0)
+            opt.cpu = atoi(a + 6);
+        else if (strncmp(a, "--json=", 7) == 0)
+            opt.json = a + 7;
+        else {
+            fprintf(stderr, "usage: %s [--filter=substr] [--min-time=0.5] [--warmup=0.1] "
+                            "[--samples=20] [--cpu=N] [--json=out.json]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (opt.cpu >= 0 && !pin_to_cpu(opt.cpu)) {
+        fprintf(stderr, "cannot pin to CPU %d\n", opt.cpu);
+        opt.cpu = -1;
+    }
+
+    printf("%-36s %12s %12s %12s %23s %8s\n", "benchmark", "iterations", "mean ns", "median ns",
+           "95% CI ns", "outliers");
+    std::vector<Result> results;
+    for (const Benchmark& b : registry()) {
+        if (!opt.filter.empty() && b.name.find(opt.filter) == std::string::npos)
+            continue;
+        Result r = measure(b, opt);
+        char ci[64];
+        snprintf(ci, sizeof(ci), "[%.2f, %.2f]", r.ci_low, r.ci_high);
+        printf("%-36s %12llu %12.2f %12.2f %23s %5d/%-2d", r.name.c_str(),
+               (unsigned long long)r.iterations, r.mean, r.median, ci, r.outliers,
+               r.outliers + r.samples);
+        if (r.items_per_second > 0)
+            printf(" %.3g items/s", r.items_per_second);
+        printf("\n");
+        fflush(stdout);
+        results.push_back(r);
+    }
+    if (!opt.json.empty())
+        write_json(opt.json, argv[0], opt, results);
+    return 0;
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCH(fn, ...) \
+    static bench::Registrar BENCH_CONCAT(bench_registrar_, __LINE__)(#fn, fn, {__VA_ARGS__})
+#define BENCH_MAIN() \
+    int main(int argc, char** argv) { return bench::run_all(argc, argv); }
+
+#endif // BENCH_HPP
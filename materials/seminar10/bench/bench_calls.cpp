@@ -0,0 +1,58 @@
+// Benchmarks of the seminar11 examples: the a() loop of ../../seminar11/1.cpp and the
+// check() && (i%2) condition of ../../seminar11/2_reordering.cpp in both orders.
+// The functions are copies: the originals are profiling subjects with their own main().
+#include "bench.hpp"
+
+__attribute__((noinline)) int a() {
+    long k = 0;
+    for (int i = 0; i < 523; i++)
+        k = 1 + i + k / 365;
+    return k;
+}
+
+__attribute__((noinline)) int check() {
+    for (int i = 0; i < 4096; i++)
+        bench::clobber_memory();   // the dummy cycle survives -O2 like it does at -O0
+    return 1;
+}
+
+// one call of a()
+static void bm_a(bench::State& st) {
+    while (st.keep_running())
+        bench::do_not_optimize(a());
+}
+BENCH(bm_a);
+
+// main() of 1.cpp: a() for odd i, 1M iterations; without do_not_optimize -O2 removes it all
+static void bm_a_loop(bench::State& st) {
+    while (st.keep_running()) {
+        for (int i = 0; i < 1024 * 1024; i++)
+            if (i % 2)
+                bench::do_not_optimize(a());
+    }
+}
+BENCH(bm_a_loop);
+
+static void bm_check_first(bench::State& st) {
+    while (st.keep_running()) {
+        int hits = 0;
+        for (int i = 0; i < 4096; i++)
+            if (check() && (i % 2))
+                hits++;
+        bench::do_not_optimize(hits);
+    }
+}
+BENCH(bm_check_first);
+
+static void bm_check_last(bench::State& st) {
+    while (st.keep_running()) {
+        int hits = 0;
+        for (int i = 0; i < 4096; i++)
+            if ((i % 2) && check())
+                hits++;
+        bench::do_not_optimize(hits);
+    }
+}
+BENCH(bm_check_last);
+
+BENCH_MAIN();
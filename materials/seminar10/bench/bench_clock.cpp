@@ -0,0 +1,42 @@
+// Benchmarks of LamportClock (../../../2024/parprog/distributed/lamport_clock/clock.hpp):
+// the cost of the atomic operations mentioned in its comments, vs a plain counter.
+#include "bench.hpp"
+#include "../../../2024/parprog/distributed/lamport_clock/clock.hpp"
+
+static void bm_plain_increment(bench::State& st) {
+    unsigned t = 0;
+    while (st.keep_running()) {
+        t++;
+        bench::do_not_optimize(t);
+    }
+}
+BENCH(bm_plain_increment);
+
+static void bm_local_event(bench::State& st) {
+    LamportClock clock;
+    while (st.keep_running())
+        bench::do_not_optimize(clock.local_event());
+}
+BENCH(bm_local_event);
+
+// received time is always ahead: the compare-exchange path
+static void bm_receive_event_ahead(bench::State& st) {
+    LamportClock clock;
+    LamportClock::LamportTime received = 0;
+    while (st.keep_running()) {
+        received += 2;
+        bench::do_not_optimize(clock.receive_event(received));
+    }
+}
+BENCH(bm_receive_event_ahead);
+
+// received time is old: a single fetch_add
+static void bm_receive_event_old(bench::State& st) {
+    LamportClock clock;
+    clock.receive_event(1000);
+    while (st.keep_running())
+        bench::do_not_optimize(clock.receive_event(1));
+}
+BENCH(bm_receive_event_old);
+
+BENCH_MAIN();
@@ -0,0 +1,47 @@
+// Benchmarks of ../prefetch/prefetch_kernels.hpp with and without prefetching,
+// at the distance/hint the tuner usually picks. arg = working set in KiB.
+#include <cstdint>
+#include <random>
+#include "bench.hpp"
+#include "../prefetch/prefetch_kernels.hpp"
+
+static const size_t ACCESSES = 1 << 16;
+
+static Workload& workload(size_t kib) {
+    static std::mt19937_64 rng(42);
+    static std::vector<std::pair<size_t, Workload*>> cache;
+    for (auto& w : cache)
+        if (w.first == kib)
+            return *w.second;
+    cache.emplace_back(kib, new Workload(kib << 10, ACCESSES, rng));
+    return *cache.back().second;
+}
+
+template <int DIST>
+static void bm_gather(bench::State& st) {
+    Workload& w = workload(st.arg());
+    while (st.keep_running())
+        bench::do_not_optimize(gather<0>(w.data.data(), w.idx.data(), ACCESSES, DIST));
+    st.set_items_per_iteration(ACCESSES);
+}
+
+template <int DIST>
+static void bm_probe(bench::State& st) {
+    Workload& w = workload(st.arg());
+    while (st.keep_running())
+        bench::do_not_optimize(probe<0>(w.buckets.data(), w.buckets.size() - 1, w.pool.data(),
+                                        w.keys.data(), ACCESSES, DIST));
+    st.set_items_per_iteration(ACCESSES);
+}
+
+static void bm_gather_no_prefetch(bench::State& st) { bm_gather<0>(st); }
+static void bm_gather_prefetch16(bench::State& st) { bm_gather<16>(st); }
+static void bm_probe_no_prefetch(bench::State& st) { bm_probe<0>(st); }
+static void bm_probe_prefetch16(bench::State& st) { bm_probe<16>(st); }
+
+BENCH(bm_gather_no_prefetch, 512, 262144);
+BENCH(bm_gather_prefetch16, 512, 262144);
+BENCH(bm_probe_no_prefetch, 512, 262144);
+BENCH(bm_probe_prefetch16, 512, 262144);
+
+BENCH_MAIN();
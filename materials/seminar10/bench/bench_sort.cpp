@@ -0,0 +1,139 @@
+// Benchmarks of the sorting examples: quickSort of ../pgo/pgo-1.cpp, ../sort/adaptive_sort.hpp
+// and ../sort/indirect_sort.hpp. Input generation is excluded from timing.
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "../pgo/quick_sort.hpp"
+#include "../sort/adaptive_sort.hpp"
+#include "../sort/indirect_sort.hpp"
+
+static std::vector<unsigned char> bytes(size_t n, unsigned mod) {
+    // the generator of pgo-1.cpp: ++number % MOD
+    std::vector<unsigned char> v(n);
+    unsigned char number = 0;
+    for (auto& x : v)
+        x = ++number % mod;
+    return v;
+}
+
+static std::vector<uint32_t> random_u32(size_t n) {
+    std::mt19937 rng(1);
+    std::vector<uint32_t> v(n);
+    for (auto& x : v)
+        x = rng();
+    return v;
+}
+
+// pgo-1.cpp workload: 64K bytes, arg = MOD
+static void bm_quicksort_pgo(bench::State& st) {
+    std::vector<unsigned char> input = bytes(1 << 16, st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        quickSort(v.data(), 0, (int)v.size() - 1);
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_quicksort_pgo, 16, 256);
+
+static void bm_quicksort_random(bench::State& st) {
+    std::vector<uint32_t> input = random_u32(st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        quickSort(v.data(), 0, (int)v.size() - 1);
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_quicksort_random, 1 << 16, 1 << 20);
+
+static void bm_std_sort_random(bench::State& st) {
+    std::vector<uint32_t> input = random_u32(st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        std::sort(v.begin(), v.end());
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_std_sort_random, 1 << 16, 1 << 20);
+
+static void bm_adaptive_sort_random(bench::State& st) {
+    std::vector<uint32_t> input = random_u32(st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        adaptive_sort(v.data(), v.size());
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_adaptive_sort_random, 1 << 16, 1 << 20);
+
+// sorted input with 1% of elements displaced
+static void bm_adaptive_sort_nearly(bench::State& st) {
+    std::vector<uint32_t> input = random_u32(st.arg()), v;
+    std::sort(input.begin(), input.end());
+    std::mt19937 rng(2);
+    for (size_t i = 0; i < input.size() / 100; i++)
+        std::swap(input[rng() % input.size()], input[rng() % input.size()]);
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        adaptive_sort(v.data(), v.size());
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_adaptive_sort_nearly, 1 << 20);
+
+struct Record256 {
+    uint64_t key;
+    char payload[248];
+};
+
+static std::vector<Record256> records(size_t n) {
+    std::mt19937_64 rng(3);
+    std::vector<Record256> v(n);
+    for (auto& r : v)
+        r.key = rng();
+    return v;
+}
+
+static void bm_records_direct(bench::State& st) {
+    std::vector<Record256> input = records(st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        std::sort(v.begin(), v.end(), [](const Record256& l, const Record256& r) { return l.key < r.key; });
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_records_direct, 1 << 16);
+
+static void bm_records_key_index(bench::State& st) {
+    std::vector<Record256> input = records(st.arg()), v;
+    while (st.keep_running()) {
+        st.pause_timing();
+        v = input;
+        st.resume_timing();
+        key_index_sort(v.data(), v.size(), [](const Record256& r) { return r.key; });
+        bench::clobber_memory();
+    }
+    st.set_items_per_iteration(v.size());
+}
+BENCH(bm_records_key_index, 1 << 16);
+
+BENCH_MAIN();
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+# Benchmark history: an append-only columnar store of bench.hpp JSON reports (../bench.hpp)
+# and change-point detection over it. No services, one file per store.
+#
+# usage: python3 benchhist.py add <store> <report.json>... [--commit=sha]
+#        python3 benchhist.py show <store> [--filter=substr] [--machine=id]
+#        python3 benchhist.py check <store> [--filter=substr] [--machine=id] [--alpha=0.01]
+#                                   [--threshold=5] [--min-segment=3]
+#
+# Store format: one JSON object per line, every line is a batch (one report) stored by column:
+#   {"v": 1, "commit": ..., "machine": ..., "date": ..., "context": {...},
+#    "columns": {"name": [...], "median_ns": [...], "mean_ns": [...], ...}}
+# Lines are only appended, so a store can be kept in git or copied between machines and
+# concatenated. The machine fingerprint is a hash of host, CPU model, compiler and pinned CPU:
+# results of different machines are never compared.
+import hashlib
+import json
+import math
+import os
+import sys
+from collections import defaultdict
+
+FORMAT_VERSION = 1
+COLUMNS = ["name", "iterations", "samples", "outliers", "mean_ns", "median_ns", "stddev_ns", "min_ns",
+           "ci95_low_ns", "ci95_high_ns", "items_per_second"]
+
+
+def fingerprint(context):
+    key = "|".join(str(context.get(k, "")) for k in ("host", "cpu", "compiler", "pinned_cpu"))
+    return hashlib.sha1(key.encode()).hexdigest()[:12]
+
+
+def to_batch(report, commit=None):
+    ctx = report.get("context", {})
+    rows = report.get("benchmarks", [])
+    return {"v": FORMAT_VERSION,
+            "commit": commit or ctx.get("commit") or "unknown",
+            "machine": fingerprint(ctx),
+            "date": ctx.get("date", 0),
+            "context": ctx,
+            "columns": {c: [r.get(c) for r in rows] for c in COLUMNS}}
+
+
+def append(store, batches):
+    with open(store, "a") as f:
+        for b in batches:
+            f.write(json.dumps(b, separators=(",", ":")) + "\n")
+
+
+def read_store(store):
+    batches = []
+    with open(store) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                b = json.loads(line)
+            except ValueError:
+                # a torn last line after a crash must not make the whole history unreadable
+                print("%s:%d: skipping damaged batch" % (store, lineno), file=sys.stderr)
+                continue
+            if b.get("v") == FORMAT_VERSION:
+                batches.append(b)
+    return batches
+
+
+def series(batches, name_filter="", machine=None):
+    """Returns {(machine, benchmark): [(commit, date, median_ns)]} in insertion order."""
+    out = defaultdict(list)
+    for b in batches:
+        if machine and b["machine"] != machine:
+            continue
+        cols = b["columns"]
+        for i, name in enumerate(cols["name"]):
+            if name_filter in name and cols["median_ns"][i] is not None:
+                out[(b["machine"], name)].append((b["commit"], b["date"], cols["median_ns"][i]))
+    return out
+
+
+# --- statistics -------------------------------------------------------------------------------
+
+def normal_sf(z):
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def mann_whitney(x, y):
+    """Two-sided Mann-Whitney U test (normal approximation with tie correction). Returns p-value."""
+    n1, n2 = len(x), len(y)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    values = sorted([(v, 0) for v in x] + [(v, 1) for v in y])
+    ranks = [0.0] * len(values)
+    ties = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        t = j - i + 1
+        ties += t ** 3 - t
+        i = j + 1
+    r1 = sum(r for r, (_, g) in zip(ranks, values) if g == 0)
+    u = r1 - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+    if var <= 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2) - 0.5) / math.sqrt(var)   # continuity correction
+    return min(1.0, 2 * normal_sf(max(z, 0.0)))
+
+
+def cusum_split(values):
+    """Index k maximizing |sum(values[:k] - mean)|: the most likely single change point."""
+    mean = sum(values) / len(values)
+    s, best, best_k = 0.0, -1.0, 0
+    for k, v in enumerate(values[:-1], 1):
+        s += v - mean
+        if abs(s) > best:
+            best, best_k = abs(s), k
+    return best_k
+
+
+def change_points(values, alpha, min_segment):
+    """Binary segmentation: CUSUM proposes a split, Mann-Whitney accepts it."""
+    found = []
+
+    def split(lo, hi):
+        if hi - lo < 2 * min_segment:
+            return
+        k = lo + cusum_split(values[lo:hi])
+        k = min(max(k, lo + min_segment), hi - min_segment)
+        p = mann_whitney(values[lo:k], values[k:hi])
+        if p < alpha:
+            found.append((k, p))
+            split(lo, k)
+            split(k, hi)
+
+    split(0, len(values))
+    return sorted(found)
+
+
+def median(v):
+    s = sorted(v)
+    return (s[(len(s) - 1) // 2] + s[len(s) // 2]) / 2
+
+
+# --- commands ---------------------------------------------------------------------------------
+
+def parse_options(argv, defaults):
+    opts, positional = dict(defaults), []
+    for a in argv:
+        if a.startswith("--") and "=" in a:
+            k, v = a[2:].split("=", 1)
+            if k not in opts:
+                print("unknown option --%s" % k, file=sys.stderr)
+                sys.exit(2)
+            opts[k] = v
+        else:
+            positional.append(a)
+    return opts, positional
+
+
+def cmd_add(argv):
+    opts, pos = parse_options(argv, {"commit": ""})
+    if len(pos) < 2:
+        usage()
+    store, reports = pos[0], pos[1:]
+    batches = []
+    for path in reports:
+        with open(path) as f:
+            batches.append(to_batch(json.load(f), opts["commit"] or None))
+    append(store, batches)
+    for path, b in zip(reports, batches):
+        print("%s: %d benchmarks, commit %s, machine %s"
+              % (path, len(b["columns"]["name"]), b["commit"][:12], b["machine"]))
+
+
+def cmd_show(argv):
+    opts, pos = parse_options(argv, {"filter": "", "machine": ""})
+    if len(pos) != 1:
+        usage()
+    for (machine, name), points in sorted(series(read_store(pos[0]), opts["filter"], opts["machine"]).items()):
+        print("%s  [machine %s]" % (name, machine))
+        for commit, date, ns in points:
+            print("    %-12s %12.1f ns" % (commit[:12], ns))
+
+
+def cmd_check(argv):
+    opts, pos = parse_options(argv, {"filter": "", "machine": "", "alpha": "0.01", "threshold": "5",
+                                     "min-segment": "3"})
+    if len(pos) != 1:
+        usage()
+    alpha, threshold, min_segment = float(opts["alpha"]), float(opts["threshold"]), int(opts["min-segment"])
+    regressions = 0
+    for (machine, name), points in sorted(series(read_store(pos[0]), opts["filter"], opts["machine"]).items()):
+        values = [p[2] for p in points]
+        pvalues = dict(change_points(values, alpha, min_segment))
+        bounds = [0] + sorted(pvalues) + [len(values)]
+        for lo, k, hi in zip(bounds, bounds[1:], bounds[2:]):
+            before, after = median(values[lo:k]), median(values[k:hi])
+            change = (after - before) / before * 100
+            if abs(change) < threshold:
+                continue
+            kind = "SLOWDOWN" if change > 0 else "speedup"
+            regressions += change > 0
+            print("%-8s %-40s %+7.1f%%  %10.1f -> %10.1f ns  at commit %-12s (p=%.2g, machine %s)"
+                  % (kind, name, change, before, after, points[k][0][:12], pvalues[k], machine))
+    if regressions:
+        print("%d slowdown(s) found" % regressions)
+    sys.exit(1 if regressions else 0)
+
+
+def usage():
+    print("usage: benchhist.py add <store> <report.json>... [--commit=sha]\n"
+          "       benchhist.py show <store> [--filter=substr] [--machine=id]\n"
+          "       benchhist.py check <store> [--filter=substr] [--machine=id] [--alpha=0.01]"
+          " [--threshold=5] [--min-segment=3]", file=sys.stderr)
+    sys.exit(2)
+
+
+def main():
+    commands = {"add": cmd_add, "show": cmd_show, "check": cmd_check}
+    if len(sys.argv) < 2 or sys.argv[1] not in commands:
+        usage()
+    commands[sys.argv[1]](sys.argv[2:])
+
+
+if __name__ == "__main__":
+    main()
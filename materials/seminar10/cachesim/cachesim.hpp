@@ -0,0 +1,521 @@
+// Cache hierarchy simulator for machines without perf access, see readme.md.
+//
+// Accesses are recorded by instrumentation macros in marked regions (CACHESIM_LOAD / CACHESIM_PREFETCH
+// inside a cachesim::Region) into a thread-local batch; full batches are run through a model of
+// set-associative levels (L1, L2, LLC by default) with LRU or tree-PLRU replacement.
+// Misses are attributed to the source line of the macro.
+//
+// Model: one core, shared line size, non-inclusive levels filled on the way to the missing level,
+// loads and stores alike (write-allocate). A prefetch fills the hierarchy like a load but is not
+// counted as a demand access; it arrives instantly, so the model shows the best case of prefetching.
+#ifndef CACHESIM_HPP
+#define CACHESIM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace cachesim {
+
+enum class Policy { LRU, PLRU };
+
+struct LevelConfig {
+    std::string name;
+    size_t size;
+    size_t ways;
+    Policy policy;
+};
+
+const size_t LINE = 64;
+const int LINE_BITS = 6;
+const int MAX_LEVELS = 4;
+
+/**
+ * One set-associative level. Tags are full line addresses, stored per set and padded to a
+ * multiple of 4 ways so that a set is searched with AVX2 compares of 4 tags at a time.
+ * LRU keeps a 32-byte row of ages per set (0 = most recent, ways - 1 = victim), updated with one
+ * AVX2 compare and subtract; PLRU keeps a bit tree per set.
+ */
+class Level {
+public:
+    explicit Level(const LevelConfig& c) : config_(c) {
+        if (c.ways == 0 || c.size < c.ways * LINE)
+            throw std::invalid_argument("cachesim: level " + c.name + " is smaller than one set");
+        if (c.policy == Policy::PLRU && ((c.ways & (c.ways - 1)) != 0 || c.ways > 64))
+            throw std::invalid_argument("cachesim: PLRU needs a power of two ways <= 64 in " + c.name);
+        if (c.policy == Policy::LRU && c.ways > AGE_ROW)
+            throw std::invalid_argument("cachesim: LRU supports up to 32 ways in " + c.name);
+        sets_ = c.size / (c.ways * LINE);
+        pow2_ = (sets_ & (sets_ - 1)) == 0;
+        inv_sets_ = 1.0 / sets_;
+        stride_ = (c.ways + 3) & ~size_t(3);
+        tags_.assign(sets_ * stride_, EMPTY);
+        if (c.policy == Policy::PLRU) {
+            plru_.assign(sets_, 0);
+        } else {
+            // a permutation of 0..ways-1 per set; padding is never younger than a real way
+            ages_.assign(sets_ * AGE_ROW, AGE_PAD);
+            for (size_t set = 0; set < sets_; set++)
+                for (size_t w = 0; w < c.ways; w++)
+                    ages_[set * AGE_ROW + w] = (uint8_t)w;
+        }
+        for (size_t w = 1; w < c.ways; w <<= 1)
+            tree_depth_++;
+    }
+
+    const LevelConfig& config() const { return config_; }
+
+    size_t set_of(uint64_t line) const {
+        if (pow2_)
+            return line & (sets_ - 1);
+        // line % sets_ without a division: line < 2^58, the double quotient is off by at most one
+        uint64_t q = (uint64_t)((double)line * inv_sets_);
+        int64_t r = (int64_t)(line - q * sets_);
+        if (r < 0)
+            r += sets_;
+        else if (r >= (int64_t)sets_)
+            r -= sets_;
+        return (size_t)r;
+    }
+
+    // hint for the batch loop: the tags (and ages) of the set will be needed soon
+    void prefetch_set(uint64_t line) const {
+        size_t set = set_of(line);
+        __builtin_prefetch(&tags_[set * stride_]);
+        if (stride_ > 8)
+            __builtin_prefetch(&tags_[set * stride_ + 8]);
+        if (!ages_.empty())
+            __builtin_prefetch(&ages_[set * AGE_ROW]);
+    }
+
+    /** Looks the line up, inserts it on a miss. @return true on hit. */
+    bool access(uint64_t line) {
+        size_t set = set_of(line);
+        uint64_t* tags = &tags_[set * stride_];
+        if (config_.policy == Policy::LRU) {
+            uint8_t* ages = &ages_[set * AGE_ROW];
+            int way = find(tags, line);
+            bool hit = way >= 0;
+            if (!hit) {
+                way = oldest(ages);
+                tags[way] = line;
+            }
+            make_youngest(ages, way);
+            return hit;
+        }
+        int way = find(tags, line);
+        bool hit = way >= 0;
+        if (!hit) {
+            way = victim(set, tags);
+            tags[way] = line;
+        }
+        touch(set, way);
+        return hit;
+    }
+
+private:
+    static constexpr uint64_t EMPTY = ~0ULL;   // never a line address (those are shifted right)
+    static constexpr size_t AGE_ROW = 32;
+    static constexpr uint8_t AGE_PAD = 127;    // > any age, also as a signed byte
+
+    int oldest(const uint8_t* ages) const {
+#ifdef __AVX2__
+        __m256i v = _mm256_loadu_si256((const __m256i*)ages);
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)(config_.ways - 1))));
+        return __builtin_ctz(mask);
+#else
+        return (int)(std::find(ages, ages + config_.ways, (uint8_t)(config_.ways - 1)) - ages);
+#endif
+    }
+
+    // ways younger than `way` age by one, `way` becomes 0
+    static void make_youngest(uint8_t* ages, int way) {
+        uint8_t age = ages[way];
+#ifdef __AVX2__
+        __m256i v = _mm256_loadu_si256((const __m256i*)ages);
+        __m256i younger = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)age), v);   // -1 where ages[w] < age
+        v = _mm256_sub_epi8(v, younger);
+        _mm256_storeu_si256((__m256i*)ages, v);
+#else
+        for (size_t w = 0; w < AGE_ROW; w++)
+            ages[w] += ages[w] < age;
+#endif
+        ages[way] = 0;
+    }
+
+    int find(const uint64_t* tags, uint64_t line) const {
+#ifdef __AVX2__
+        __m256i key = _mm256_set1_epi64x((long long)line);
+        for (size_t w = 0; w < stride_; w += 4) {
+            __m256i t = _mm256_loadu_si256((const __m256i*)(tags + w));
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(t, key)));
+            if (mask)
+                return (int)w + __builtin_ctz(mask);
+        }
+#else
+        for (size_t w = 0; w < config_.ways; w++) {
+            if (tags[w] == line)
+                return (int)w;
+        }
+#endif
+        return -1;
+    }
+
+    // PLRU only
+    int victim(size_t set, const uint64_t* tags) {
+        if (filled_ < sets_ * config_.ways) {   // once every way holds a line, no set has an empty one
+            for (size_t w = 0; w < config_.ways; w++) {
+                if (tags[w] == EMPTY) {
+                    filled_++;
+                    return (int)w;
+                }
+            }
+        }
+        // follow the tree bits, each points to the less recently used half
+        uint64_t bits = plru_[set];
+        size_t node = 1;
+        for (int d = 0; d < tree_depth_; d++)
+            node = 2 * node + ((bits >> node) & 1);
+        return (int)(node - config_.ways);
+    }
+
+    // PLRU only: point every node on the path away from the accessed way
+    void touch(size_t set, int way) {
+        uint64_t& bits = plru_[set];
+        size_t node = 1;
+        for (int d = tree_depth_ - 1; d >= 0; d--) {
+            uint64_t right = (way >> d) & 1;
+            bits = (bits & ~(1ULL << node)) | ((right ^ 1) << node);
+            node = 2 * node + right;
+        }
+    }
+
+    LevelConfig config_;
+    size_t sets_ = 0, stride_ = 0;
+    bool pow2_ = true;
+    double inv_sets_ = 0;
+    int tree_depth_ = 0;
+    size_t filled_ = 0;              // PLRU: ways that got a line, up to sets_ * ways
+    std::vector<uint64_t> tags_;
+    std::vector<uint8_t> ages_;      // LRU: AGE_ROW ages per set
+    std::vector<uint64_t> plru_;     // PLRU: tree bits per set, node i at bit i
+};
+
+/** Levels from the nearest to the farthest. access() returns the index of the level that hit, size() for memory. */
+class Hierarchy {
+public:
+    explicit Hierarchy(const std::vector<LevelConfig>& levels) {
+        if (levels.empty() || levels.size() > MAX_LEVELS)
+            throw std::invalid_argument("cachesim: 1.." + std::to_string(MAX_LEVELS) + " levels expected");
+        for (auto& c : levels)
+            levels_.emplace_back(c);
+    }
+
+    size_t size() const { return levels_.size(); }
+    const Level& level(size_t i) const { return levels_[i]; }
+
+    size_t access(uint64_t addr) {
+        uint64_t line = addr >> LINE_BITS;
+        size_t i = 0;
+        while (i < levels_.size() && !levels_[i].access(line))
+            i++;
+        return i;
+    }
+
+    Level& level(size_t i) { return levels_[i]; }
+
+private:
+    std::vector<Level> levels_;
+};
+
+inline size_t parse_size(const std::string& s) {
+    char* end = nullptr;
+    double v = strtod(s.c_str(), &end);
+    switch (end && *end ? *end : ' ') {
+    case 'K': case 'k': return (size_t)(v * 1024);
+    case 'M': case 'm': return (size_t)(v * 1024 * 1024);
+    case 'G': case 'g': return (size_t)(v * 1024 * 1024 * 1024);
+    default: return (size_t)v;
+    }
+}
+
+/**
+ * "L1:32K:8:plru,L2:1M:16:lru,LLC:32M:16:lru" -- name:size:ways[:lru|plru] per level.
+ * Throws std::invalid_argument on a malformed description.
+ */
+inline std::vector<LevelConfig> parse_config(const std::string& text) {
+    std::vector<LevelConfig> levels;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t comma = text.find(',', pos);
+        std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? text.size() : comma + 1;
+        std::vector<std::string> f;
+        for (size_t p = 0, c; p <= item.size(); p = c + 1) {
+            c = item.find(':', p);
+            if (c == std::string::npos)
+                c = item.size();
+            f.push_back(item.substr(p, c - p));
+        }
+        if (f.size() < 3 || f.size() > 4)
+            throw std::invalid_argument("cachesim: bad level '" + item + "', expected name:size:ways[:lru|plru]");
+        Policy policy = f.size() == 4 && f[3] == "plru" ? Policy::PLRU : Policy::LRU;
+        levels.push_back(LevelConfig{f[0], parse_size(f[1]), (size_t)atoi(f[2].c_str()), policy});
+    }
+    return levels;
+}
+
+/** The caches of this machine (sysconf), PLRU in L1 like most x86 cores; typical sizes where unknown. */
+inline std::vector<LevelConfig> host_config() {
+    auto get = [](int name, long fallback) {
+        long v = sysconf(name);
+        return v > 0 ? v : fallback;
+    };
+    size_t l1_ways = get(_SC_LEVEL1_DCACHE_ASSOC, 8);
+    return {
+        {"L1", (size_t)get(_SC_LEVEL1_DCACHE_SIZE, 32 << 10), l1_ways,
+         (l1_ways & (l1_ways - 1)) == 0 ? Policy::PLRU : Policy::LRU},
+        {"L2", (size_t)get(_SC_LEVEL2_CACHE_SIZE, 1 << 20), (size_t)get(_SC_LEVEL2_CACHE_ASSOC, 16), Policy::LRU},
+        {"LLC", (size_t)get(_SC_LEVEL3_CACHE_SIZE, 32 << 20), (size_t)get(_SC_LEVEL3_CACHE_ASSOC, 16), Policy::LRU},
+    };
+}
+
+// --- instrumentation -----------------------------------------------------------------------------
+
+struct Site {
+    const char* file;
+    int line;
+    uint64_t accesses = 0;                 // demand accesses
+    uint64_t prefetches = 0;
+    uint64_t misses[MAX_LEVELS] = {};      // demand misses per level
+};
+
+struct Access {
+    uint64_t addr;
+    uint32_t site;
+    uint32_t prefetch;
+};
+
+const size_t BATCH = 4096;
+const size_t LOOKAHEAD = 16;   // the set of access i + LOOKAHEAD is prefetched while i is simulated
+
+/** Process-wide simulator state; batches from all threads go through one hierarchy (one core's view). */
+class Simulator {
+public:
+    static Simulator& instance() {
+        static Simulator* s = new Simulator;   // never destroyed: reports may run from atexit
+        return *s;
+    }
+
+    /** Replaces the hierarchy, clears statistics. */
+    void configure(const std::vector<LevelConfig>& levels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hierarchy_.reset(new Hierarchy(levels));
+        last_line_ = ~0ULL;
+        for (auto& s : sites_) {
+            s.accesses = s.prefetches = 0;
+            std::fill(s.misses, s.misses + MAX_LEVELS, 0);
+        }
+    }
+
+    uint32_t register_site(const char* file, int line) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < sites_.size(); i++)
+            if (sites_[i].line == line && strcmp(sites_[i].file, file) == 0)
+                return (uint32_t)i;
+        sites_.push_back(Site{file, line});
+        return (uint32_t)sites_.size() - 1;
+    }
+
+    /**
+     * Runs accesses through the hierarchy, a batch at a time and level by level: the first level sees
+     * the whole batch, the next one only what missed, in the same order. That is the same result as
+     * walking every access down the levels (a level is not affected by the ones behind it), but the
+     * sets of the large levels, which miss in the host caches themselves, are prefetched
+     * LOOKAHEAD misses ahead and their loads overlap.
+     */
+    void simulate(const Access* a, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hierarchy_)
+            hierarchy_.reset(new Hierarchy(env_config()));
+        for (size_t start = 0; start < n; start += BATCH)
+            simulate_batch(a + start, std::min(BATCH, n - start));
+    }
+
+    /** Per-line table, sorted by misses of the last level, with the source text of the line. */
+    void report(FILE* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hierarchy_)
+            return;
+        size_t levels = hierarchy_->size();
+        std::vector<const Site*> order;
+        for (auto& s : sites_)
+            if (s.accesses || s.prefetches)
+                order.push_back(&s);
+        std::sort(order.begin(), order.end(), [&](const Site* a, const Site* b) {
+            for (size_t l = levels; l-- > 0;)
+                if (a->misses[l] != b->misses[l])
+                    return a->misses[l] > b->misses[l];
+            return a->accesses > b->accesses;
+        });
+        fprintf(out, "cachesim:");
+        for (size_t l = 0; l < levels; l++) {
+            const LevelConfig& c = hierarchy_->level(l).config();
+            fprintf(out, " %s %zuK/%zu-way/%s", c.name.c_str(), c.size >> 10, c.ways,
+                    c.policy == Policy::LRU ? "LRU" : "PLRU");
+        }
+        fprintf(out, "\n%-28s %12s %10s", "site", "accesses", "prefetch");
+        for (size_t l = 0; l < levels; l++)
+            fprintf(out, " %10s %7s", (hierarchy_->level(l).config().name + " miss").c_str(), "%");
+        fprintf(out, "  source\n");
+        for (const Site* s : order) {
+            const char* base = strrchr(s->file, '/');
+            std::string where = std::string(base ? base + 1 : s->file) + ":" + std::to_string(s->line);
+            fprintf(out, "%-28s %12llu %10llu", where.c_str(), (unsigned long long)s->accesses,
+                    (unsigned long long)s->prefetches);
+            for (size_t l = 0; l < levels; l++)
+                fprintf(out, " %10llu %6.2f%%", (unsigned long long)s->misses[l],
+                        s->accesses ? 100.0 * s->misses[l] / s->accesses : 0.0);
+            fprintf(out, "  %s\n", source_line(s->file, s->line).c_str());
+        }
+    }
+
+private:
+    Simulator() = default;
+
+    static std::vector<LevelConfig> env_config() {
+        const char* env = getenv("CACHESIM_CONFIG");
+        return env ? parse_config(env) : host_config();
+    }
+
+    static std::string source_line(const char* file, int line) {
+        FILE* f = fopen(file, "r");
+        if (!f)
+            return "";
+        char buf[256];
+        std::string text;
+        for (int i = 1; fgets(buf, sizeof(buf), f); i++) {
+            if (i == line) {
+                text = buf;
+                break;
+            }
+        }
+        fclose(f);
+        size_t b = text.find_first_not_of(" \t");
+        size_t e = text.find_last_not_of(" \t\r\n");
+        return b == std::string::npos ? "" : text.substr(b, e - b + 1);
+    }
+
+    void simulate_batch(const Access* a, size_t n) {
+        Hierarchy& h = *hierarchy_;
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            Site& s = sites_[a[i].site];
+            if (a[i].prefetch)
+                s.prefetches++;
+            else
+                s.accesses++;
+            // the line of the previous access is the most recent one in the first level: a hit that
+            // changes neither LRU order nor PLRU bits, so runs within a line are skipped exactly
+            uint64_t line = a[i].addr >> LINE_BITS;
+            if (line != last_line_) {
+                pending_[count++] = (uint32_t)i;
+                last_line_ = line;
+            }
+        }
+        for (size_t l = 0; l < h.size() && count; l++) {
+            Level& level = h.level(l);
+            size_t missed = 0;
+            for (size_t k = 0; k < count; k++) {
+                if (l > 0 && k + LOOKAHEAD < count)   // the first level is small and stays in the host's cache
+                    level.prefetch_set(a[pending_[k + LOOKAHEAD]].addr >> LINE_BITS);
+                const Access& x = a[pending_[k]];
+                if (!level.access(x.addr >> LINE_BITS)) {
+                    pending_[missed++] = pending_[k];   // in place: missed <= k
+                    if (!x.prefetch)
+                        sites_[x.site].misses[l]++;
+                }
+            }
+            count = missed;
+        }
+    }
+
+    std::mutex mutex_;
+    std::unique_ptr<Hierarchy> hierarchy_;
+    uint32_t pending_[BATCH];   // indices of the accesses that reach the current level
+    uint64_t last_line_ = ~0ULL;
+    std::vector<Site> sites_;
+};
+
+/** Thread-local batch of accesses; recording happens only inside a Region. */
+struct Batch {
+    Access items[BATCH];
+    size_t n = 0;
+    int depth = 0;   // nesting of regions
+
+    void flush() {
+        Simulator::instance().simulate(items, n);
+        n = 0;
+    }
+    ~Batch() { flush(); }
+};
+
+inline Batch& batch() {
+    static thread_local Batch b;
+    return b;
+}
+
+inline void record(const void* p, uint32_t site, bool prefetch = false) {
+    Batch& b = batch();
+    if (b.depth == 0)
+        return;
+    b.items[b.n++] = Access{(uint64_t)(uintptr_t)p, site, prefetch};
+    if (b.n == BATCH)
+        b.flush();
+}
+
+/** Marks a region of interest: accesses are recorded between construction and destruction. */
+class Region {
+public:
+    Region() { batch().depth++; }
+    ~Region() {
+        Batch& b = batch();
+        if (--b.depth == 0)
+            b.flush();
+    }
+    Region(const Region&) = delete;
+    Region& operator=(const Region&) = delete;
+};
+
+inline void configure(const std::vector<LevelConfig>& levels) {
+    batch().flush();
+    Simulator::instance().configure(levels);
+}
+
+inline void report(FILE* out = stdout) {
+    batch().flush();
+    Simulator::instance().report(out);
+}
+
+} // namespace cachesim
+
+// Id of the current source line, registered once per expansion.
+#define CACHESIM_SITE() \
+    ([] { static const uint32_t id = ::cachesim::Simulator::instance().register_site(__FILE__, __LINE__); return id; }())
+#define CACHESIM_LOAD(p) ::cachesim::record((p), CACHESIM_SITE())
+#define CACHESIM_PREFETCH(p) ::cachesim::record((p), CACHESIM_SITE(), true)
+
+#endif // CACHESIM_HPP
@@ -0,0 +1,79 @@
+// The prefetch kernels (../prefetch/prefetch_kernels.hpp) under the cache simulator:
+// misses per source line with and without prefetching, no perf access needed.
+//   g++ -O2 -march=native cachesim_prefetch.cpp -o cachesim_prefetch
+//   ./cachesim_prefetch [working set MiB = 64] [accesses = 1000000] [distance = 16]
+//   CACHESIM_CONFIG=L1:32K:8:plru,L2:1M:16,LLC:8M:16 ./cachesim_prefetch
+//   ./cachesim_prefetch --speed          # simulator throughput
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "cachesim.hpp"
+
+#define KERNEL_LOAD(p) CACHESIM_LOAD(p)
+#define KERNEL_PREFETCH(p) CACHESIM_PREFETCH(p)
+#include "../prefetch/prefetch_kernels.hpp"
+
+// Raw simulation speed on batches of accesses, without instrumentation overhead. Every access of a stream but
+// the first moves `step` bytes within `span` bytes, and every random_every-th goes to a random address in 256 MiB.
+// With steps of 8 bytes 7 of 8 accesses stay on the line of the previous one and are skipped by the simulator;
+// with steps of a line every access is looked up.
+static double speed(cachesim::Simulator& sim, uint32_t site, uint64_t step, uint64_t span, int random_every) {
+    std::mt19937_64 rng(1);
+    const size_t N = 1 << 22;
+    std::vector<cachesim::Access> stream(N);
+    for (size_t i = 0; i < N; i++) {
+        bool random = random_every && i % random_every == 0;
+        uint64_t addr = random ? 0x40000000 + (rng() & ((256 << 20) - 1)) : 0x10000000 + i * step % span;
+        stream[i] = cachesim::Access{addr, site, 0};
+    }
+    for (size_t i = 0; i < N; i += cachesim::BATCH)   // warm-up: the simulator's tables are touched once
+        sim.simulate(&stream[i], cachesim::BATCH);
+    auto t0 = std::chrono::steady_clock::now();
+    int rounds = 10;
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < N; i += cachesim::BATCH)
+            sim.simulate(&stream[i], cachesim::BATCH);
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return rounds * N / s / 1e6;
+}
+
+static int speed() {
+    cachesim::Simulator& sim = cachesim::Simulator::instance();
+    uint32_t site = sim.register_site(__FILE__, __LINE__);
+    const uint64_t ALL = 1ULL << 40;
+    printf("sequential 8-byte steps        %7.1f M accesses/s\n", speed(sim, site, 8, ALL, 0));
+    printf("sequential lines, 16 KiB loop  %7.1f M accesses/s\n", speed(sim, site, cachesim::LINE, 16 << 10, 0));
+    printf("sequential lines, 512 KiB loop %7.1f M accesses/s\n", speed(sim, site, cachesim::LINE, 512 << 10, 0));
+    printf("sequential lines               %7.1f M accesses/s\n", speed(sim, site, cachesim::LINE, ALL, 0));
+    printf("lines, 1/16 random             %7.1f M accesses/s\n", speed(sim, site, cachesim::LINE, 16 << 10, 16));
+    printf("lines, 1/4 random              %7.1f M accesses/s\n", speed(sim, site, cachesim::LINE, 16 << 10, 4));
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--speed") == 0)
+        return speed();
+    size_t mib = argc > 1 ? atoi(argv[1]) : 64;
+    size_t accesses = argc > 2 ? atoi(argv[2]) : 1000000;
+    int dist = argc > 3 ? atoi(argv[3]) : 16;
+    std::mt19937_64 rng(42);
+    Workload w(mib << 20, accesses, rng);
+    volatile uint64_t sink = 0;
+
+    for (int d : {0, dist}) {
+        // a fresh hierarchy for each distance, cold like a separate run
+        cachesim::configure(getenv("CACHESIM_CONFIG") ? cachesim::parse_config(getenv("CACHESIM_CONFIG"))
+                                                      : cachesim::host_config());
+        {
+            cachesim::Region region;
+            sink += gather<0>(w.data.data(), w.idx.data(), accesses, d);
+            sink += probe<0>(w.buckets.data(), w.buckets.size() - 1, w.pool.data(), w.keys.data(), accesses, d);
+        }
+        printf("working set %zu MiB, %zu accesses, prefetch distance %d\n", mib, accesses, d);
+        cachesim::report(stdout);
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Thin RAII wrapper over perf_event_open(2) for in-process measurements.
+// See readme.md in this directory for usage and output format.
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCHES,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        NUM_EVENTS
+    };
+
+    /**
+     * Result of one start()/stop() interval.
+     * Counters that could not be opened (or were never scheduled on the PMU)
+     * have valid[e] == false, their value is 0.
+     */
+    struct Sample {
+        double seconds = 0;
+        uint64_t value[NUM_EVENTS] = {};
+        bool valid[NUM_EVENTS] = {};
+
+        double ratio(Event num, Event den) const {
+            if (!valid[num] || !valid[den] || value[den] == 0)
+                return -1;
+            return (double)value[num] / (double)value[den];
+        }
+        double ipc() const { return ratio(INSTRUCTIONS, CYCLES); }
+        double branch_miss_rate() const { return ratio(BRANCH_MISSES, BRANCHES); }
+        // misses per 1000 instructions
+        double mpki(Event e) const {
+            double r = ratio(e, INSTRUCTIONS);
+            return r < 0 ? -1 : r * 1000;
+        }
+    };
+
+    static const char* name(Event e) {
+        static const char* names[NUM_EVENTS] = {
+            "cycles", "instructions", "branches", "branch_misses", "l1d_misses", "llc_misses"
+        };
+        return names[e];
+    }
+
+    /**
+     * Opens the counters for the calling thread.
+     * Never fails: if perf is not permitted (perf_event_paranoid, seccomp in
+     * containers, no PMU in a VM) available() returns false and stop()
+     * reports wall time only. Set PERF_COUNTERS=0 to disable explicitly.
+     */
+    PerfCounters() {
+        for (int e = 0; e < NUM_EVENTS; e++)
+            fd_[e] = -1;
+        const char* env = getenv("PERF_COUNTERS");
+        if (env && strcmp(env, "0") == 0)
+            return;
+#ifdef __linux__
+        // Two groups: most PMUs have only 4 programmable counters, and a group
+        // is scheduled all-or-nothing, so cache events live in a separate group.
+        open_event(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        open_event(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, fd_[CYCLES]);
+        open_event(BRANCHES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, fd_[CYCLES]);
+        open_event(BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, fd_[CYCLES]);
+        open_event(L1D_MISSES, PERF_TYPE_HW_CACHE,
+                   PERF_COUNT_HW_CACHE_L1D |
+                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), -1);
+        open_event(LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, fd_[L1D_MISSES]);
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int e = 0; e < NUM_EVENTS; e++)
+            if (fd_[e] >= 0)
+                close(fd_[e]);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        for (int e = 0; e < NUM_EVENTS; e++)
+            if (fd_[e] >= 0)
+                return true;
+        return false;
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            if (is_leader(e)) {
+                ioctl(fd_[e], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(fd_[e], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+#endif
+        t0_ = std::chrono::steady_clock::now();
+    }
+
+    Sample stop() {
+        Sample s;
+        auto t1 = std::chrono::steady_clock::now();
+#ifdef __linux__
+        for (int e = 0; e < NUM_EVENTS; e++)
+            if (is_leader(e))
+                ioctl(fd_[e], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        for (int e = 0; e < NUM_EVENTS; e++)
+            if (is_leader(e))
+                read_group(e, s);
+#endif
+        s.seconds = std::chrono::duration<double>(t1 - t0_).count();
+        return s;
+    }
+
+    /**
+     * Writes a sample as one JSON object per line (JSON Lines),
+     * unavailable counters and ratios are written as null.
+     */
+    static void print_json(FILE* out, const char* phase, const Sample& s) {
+        fprintf(out, "{\"phase\":\"%s\",\"seconds\":%.9f", phase, s.seconds);
+        for (int e = 0; e < NUM_EVENTS; e++) {
+            if (s.valid[e])
+                fprintf(out, ",\"%s\":%llu", name((Event)e), (unsigned long long)s.value[e]);
+            else
+                fprintf(out, ",\"%s\":null", name((Event)e));
+        }
+        print_ratio(out, "ipc", s.ipc());
+        print_ratio(out, "branch_miss_rate", s.branch_miss_rate());
+        print_ratio(out, "l1d_mpki", s.mpki(L1D_MISSES));
+        print_ratio(out, "llc_mpki", s.mpki(LLC_MISSES));
+        fprintf(out, "}\n");
+        fflush(out);
+    }
+
+private:
+    int fd_[NUM_EVENTS];
+    int leader_[NUM_EVENTS];
+    std::chrono::steady_clock::time_point t0_;
+
+    bool is_leader(int e) const { return fd_[e] >= 0 && leader_[e] == e; }
+
+    static void print_ratio(FILE* out, const char* key, double v) {
+        if (v < 0)
+            fprintf(out, ",\"%s\":null", key);
+        else
+            fprintf(out, ",\"%s\":%.4f", key, v);
+    }
+
+#ifdef __linux__
+    void open_event(Event e, uint32_t type, uint64_t config, int group_fd) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = group_fd < 0;   // only the leader starts disabled
+        attr.exclude_kernel = 1;        // allowed with perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd_[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+        if (fd_[e] < 0) {
+            leader_[e] = -1;
+            return;
+        }
+        leader_[e] = e;
+        if (group_fd >= 0)
+            for (int l = 0; l < NUM_EVENTS; l++)
+                if (fd_[l] == group_fd)
+                    leader_[e] = l;
+        ioctl(fd_[e], PERF_EVENT_IOC_ID, &id_[e]);
+    }
+
+    void read_group(int leader, Sample& s) {
+        // layout for PERF_FORMAT_GROUP|ID|TOTAL_TIME_*: nr, enabled, running, {value, id}[nr]
+        uint64_t buf[3 + 2 * NUM_EVENTS];
+        if (read(fd_[leader], buf, sizeof(buf)) <= 0)
+            return;
+        uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+        if (running == 0)   // group was never scheduled on the PMU
+            return;
+        double scale = (double)enabled / (double)running;   // multiplexing correction
+        for (uint64_t i = 0; i < nr; i++) {
+            for (int e = 0; e < NUM_EVENTS; e++) {
+                if (fd_[e] >= 0 && leader_[e] == leader && id_[e] == buf[4 + 2 * i]) {
+                    s.value[e] = (uint64_t)((double)buf[3 + 2 * i] * scale);
+                    s.valid[e] = true;
+                }
+            }
+        }
+    }
+
+    uint64_t id_[NUM_EVENTS] = {};
+#endif
+};
+
+/**
+ * Measures the enclosing scope as one phase and prints it on destruction:
+ *
+ *     PerfCounters pc;
+ *     {
+ *         PerfPhase p(pc, "sort");
+ *         quickSort(...);
+ *     }
+ */
+class PerfPhase {
+public:
+    PerfPhase(PerfCounters& pc, const char* phase, FILE* out = stderr)
+        : pc_(pc), phase_(phase), out_(out) {
+        pc_.start();
+    }
+    ~PerfPhase() {
+        PerfCounters::print_json(out_, phase_, pc_.stop());
+    }
+
+    PerfPhase(const PerfPhase&) = delete;
+    PerfPhase& operator=(const PerfPhase&) = delete;
+
+private:
+    PerfCounters& pc_;
+    const char* phase_;
+    FILE* out_;
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -1,62 +1,11 @@
 #include <iostream>
 #include <algorithm>
 #include <stdlib.h>
+#include "../perf/perf_counters.hpp"
+#include "quick_sort.hpp"
 
 using namespace std;
 
-int partition(int arr[], int start, int end)
-{
- 
-    int pivot = arr[start];
- 
-    int count = 0;
-    for (int i = start + 1; i <= end; i++) {
-        if (arr[i] <= pivot)
-            count++;
-    }
- 
-    // Giving pivot element its correct position
-    int pivotIndex = start + count;
-    swap(arr[pivotIndex], arr[start]);
- 
-    // Sorting left and right parts of the pivot element
-    int i = start, j = end;
- 
-    while (i < pivotIndex && j > pivotIndex) {
- 
-        while (arr[i] <= pivot) {
-            i++;
-        }
- 
-        while (arr[j] > pivot) {
-            j--;
-        }
- 
-        if (i < pivotIndex && j > pivotIndex) {
-            swap(arr[i++], arr[j--]);
-        }
-    }
- 
-    return pivotIndex;
-}
- 
-void quickSort(int arr[], int start, int end)
-{
- 
-    // base case
-    if (start >= end)
-        return;
- 
-    // partitioning the array
-    int p = partition(arr, start, end);
- 
-    // Sorting the left part
-    quickSort(arr, start, p - 1);
- 
-    // Sorting the right part
-    quickSort(arr, p + 1, end);
-}
-
 const size_t MB = 1024*1024;
 size_t MOD = 0;
 
@@ -75,8 +24,16 @@ int main(int argc, char** argv) {
 
   unsigned char* garbage = (unsigned char *) malloc(BLOCK_SIZE);
 
-  std::generate_n(garbage, BLOCK_SIZE, uniqueNumber);
-  quickSort(garbage, 0, BLOCK_SIZE);
+  // per-phase counters go to stderr as JSON lines, see ../perf/readme.md
+  PerfCounters pc;
+  {
+    PerfPhase phase(pc, "generate");
+    std::generate_n(garbage, BLOCK_SIZE, uniqueNumber);
+  }
+  {
+    PerfPhase phase(pc, "sort");
+    quickSort(garbage, 0, BLOCK_SIZE - 1);
+  }
 
   free(garbage);
 
@@ -0,0 +1,117 @@
+// Kernels of prefetch_tune.cpp, shared with ../bench.
+//   gather -- sum += data[idx[i]], the simplest random access (hash probe without collisions)
+//   probe  -- hash table lookup: bucket head -> chain of nodes (dependent loads after the prefetched one)
+#ifndef PREFETCH_KERNELS_HPP
+#define PREFETCH_KERNELS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Memory access hooks, empty by default; ../cachesim/cachesim_prefetch.cpp defines them
+// to feed the cache simulator.
+#ifndef KERNEL_LOAD
+#define KERNEL_LOAD(p)
+#endif
+#ifndef KERNEL_PREFETCH
+#define KERNEL_PREFETCH(p)
+#endif
+
+struct Node {
+    uint64_t key;
+    uint32_t next;      // index in node pool, UINT32_MAX -- end of chain
+    uint32_t pad[13];   // one node per cache line
+};
+
+inline uint64_t hash64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// locality hint of __builtin_prefetch must be a compile time constant
+template <int HINT>
+uint64_t gather(const uint64_t* data, const uint32_t* idx, size_t n, int dist) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (dist) {
+            KERNEL_PREFETCH(&data[idx[i + dist]]);
+            __builtin_prefetch(&data[idx[i + dist]], 0, HINT);   // idx has dist padding at the end
+        }
+        KERNEL_LOAD(&idx[i]);
+        KERNEL_LOAD(&data[idx[i]]);
+        sum += data[idx[i]];
+    }
+    return sum;
+}
+
+template <int HINT>
+uint64_t probe(const uint32_t* buckets, size_t mask, const Node* pool,
+               const uint64_t* keys, size_t n, int dist) {
+    uint64_t found = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (dist) {
+            KERNEL_PREFETCH(&buckets[hash64(keys[i + dist]) & mask]);
+            __builtin_prefetch(&buckets[hash64(keys[i + dist]) & mask], 0, HINT);
+        }
+        KERNEL_LOAD(&keys[i]);
+        KERNEL_LOAD(&buckets[hash64(keys[i]) & mask]);
+        uint32_t cur = buckets[hash64(keys[i]) & mask];
+        while (cur != UINT32_MAX) {
+            KERNEL_LOAD(&pool[cur]);
+            if (pool[cur].key == keys[i]) {
+                found++;
+                break;
+            }
+            cur = pool[cur].next;
+        }
+    }
+    return found;
+}
+
+struct Workload {
+    size_t bytes;
+    // gather
+    std::vector<uint64_t> data;
+    std::vector<uint32_t> idx;
+    // probe
+    std::vector<uint32_t> buckets;
+    std::vector<Node> pool;
+    std::vector<uint64_t> keys;
+
+    Workload(size_t bytes, size_t accesses, std::mt19937_64& rng) : bytes(bytes) {
+        size_t n = std::max<size_t>(bytes / sizeof(uint64_t), 16);
+        data.resize(n);
+        for (size_t i = 0; i < n; i++)
+            data[i] = rng();
+        idx.resize(accesses + 64);
+        for (auto& x : idx)
+            x = rng() % n;
+
+        // hash table: bucket array + node pool share the working set, load factor ~1
+        size_t nodes = std::max<size_t>(bytes / (sizeof(Node) + sizeof(uint32_t)), 16);
+        size_t nb = 1;
+        while (nb * 2 <= nodes)
+            nb *= 2;
+        buckets.assign(nb, UINT32_MAX);
+        pool.resize(nodes);
+        std::vector<uint32_t> order(nodes);
+        for (size_t i = 0; i < nodes; i++)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);   // chain neighbours are not adjacent in memory
+        for (size_t i = 0; i < nodes; i++) {
+            Node& nd = pool[order[i]];
+            nd.key = rng();
+            uint32_t& head = buckets[hash64(nd.key) & (nb - 1)];
+            nd.next = head;
+            head = order[i];
+        }
+        keys.resize(accesses + 64);
+        for (auto& k : keys)
+            k = (rng() & 1) ? pool[rng() % nodes].key : rng();   // half hits, half misses
+    }
+};
+
+#endif // PREFETCH_KERNELS_HPP
@@ -0,0 +1,118 @@
+// Random access / pointer chasing benchmark with __builtin_prefetch autotuning.
+//
+// Kernels (gather and probe) are in prefetch_kernels.hpp.
+//
+// For every working set size (picked to fit L1, L2, LLC and to spill into DRAM) the tuner sweeps
+// prefetch distance and locality hint and prints the best setting.
+//
+// build: g++ -O2 -march=native prefetch_tune.cpp -o prefetch_tune
+// usage: ./prefetch_tune [accesses=1000000] [--max-mb=512] [--csv]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "prefetch_kernels.hpp"
+
+using namespace std;
+
+static const int DISTANCES[] = {0, 1, 2, 4, 8, 16, 32, 64};   // 0 -- no prefetch
+static const int REPEATS = 3;
+static const double MIN_GAIN = 0.03;   // prefetch is chosen only if it beats no-prefetch by 3%+
+
+static volatile uint64_t sink;   // keeps the kernels from being optimized out
+
+template <int HINT>
+double run(const Workload& w, const string& kernel, size_t accesses, int dist) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++) {
+        auto t0 = chrono::steady_clock::now();
+        if (kernel == "gather")
+            sink += gather<HINT>(w.data.data(), w.idx.data(), accesses, dist);
+        else
+            sink += probe<HINT>(w.buckets.data(), w.buckets.size() - 1, w.pool.data(),
+                                w.keys.data(), accesses, dist);
+        auto t1 = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, nano>(t1 - t0).count() / accesses);
+    }
+    return best;
+}
+
+static double run_hint(const Workload& w, const string& kernel, size_t accesses, int dist, int hint) {
+    switch (hint) {
+    case 0: return run<0>(w, kernel, accesses, dist);
+    case 1: return run<1>(w, kernel, accesses, dist);
+    case 2: return run<2>(w, kernel, accesses, dist);
+    default: return run<3>(w, kernel, accesses, dist);
+    }
+}
+
+static size_t cache_size(int name, size_t fallback) {
+    long v = sysconf(name);
+    return v > 0 ? (size_t)v : fallback;
+}
+
+int main(int argc, char** argv) {
+    size_t accesses = 1000000;
+    size_t max_bytes = 512 << 20;
+    bool csv = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else if (strncmp(argv[i], "--max-mb=", 9) == 0)
+            max_bytes = strtoull(argv[i] + 9, nullptr, 10) << 20;
+        else
+            accesses = strtoull(argv[i], nullptr, 10);
+    }
+
+    size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, 32 << 10);
+    size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, 1 << 20);
+    size_t l3 = cache_size(_SC_LEVEL3_CACHE_SIZE, 8 << 20);
+    struct { const char* level; size_t bytes; } sizes[] = {
+        {"L1", l1 / 2}, {"L2", l2 / 2}, {"LLC", l3 / 2}, {"DRAM", max<size_t>(l3 * 4, 256 << 20)}
+    };
+    for (auto& sz : sizes)
+        sz.bytes = min(sz.bytes, max_bytes);
+
+    mt19937_64 rng(42);
+    if (csv)
+        printf("kernel,level,bytes,baseline_ns,best_distance,best_hint,best_ns,speedup\n");
+    else
+        printf("%-7s %-5s %10s %12s %6s %5s %9s %8s\n",
+               "kernel", "level", "KiB", "base ns/acc", "dist", "hint", "ns/acc", "speedup");
+
+    for (auto& sz : sizes) {
+        Workload w(sz.bytes, accesses, rng);
+        for (const string kernel : {"gather", "probe"}) {
+            double base = run_hint(w, kernel, accesses, 0, 3);
+            int best_dist = 0, best_hint = 3;
+            double best = base;
+            for (int dist : DISTANCES) {
+                if (dist == 0)
+                    continue;
+                for (int hint = 0; hint <= 3; hint++) {
+                    double t = run_hint(w, kernel, accesses, dist, hint);
+                    if (t < best && t < base * (1 - MIN_GAIN)) {
+                        best = t;
+                        best_dist = dist;
+                        best_hint = hint;
+                    }
+                }
+            }
+            if (csv)
+                printf("%s,%s,%zu,%.3f,%d,%d,%.3f,%.3f\n", kernel.c_str(), sz.level, sz.bytes,
+                       base, best_dist, best_hint, best, base / best);
+            else
+                printf("%-7s %-5s %10zu %12.3f %6d %5d %9.3f %7.2fx\n", kernel.c_str(), sz.level,
+                       sz.bytes >> 10, base, best_dist, best_hint, best, base / best);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
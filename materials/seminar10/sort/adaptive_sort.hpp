@@ -0,0 +1,182 @@
+// Adaptive (natural) merge sort and incremental sorted buffer for mostly sorted data.
+//
+//   adaptive_sort -- detects natural runs (descending runs are reversed), extends short runs with
+//                    insertion sort and merges them in powersort order. O(n) on sorted input,
+//                    O(n log n) in the worst case, stable.
+//   SortedBuffer  -- keeps a sorted vector and merges new batches into it; only the overlapping
+//                    suffix of the buffer is touched, so appending ordered data is O(batch).
+#ifndef ADAPTIVE_SORT_HPP
+#define ADAPTIVE_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace adaptive_detail {
+
+const size_t MIN_RUN = 24;
+
+template <typename T, typename Cmp>
+void insertion_sort(T* a, size_t begin, size_t sorted_end, size_t end, Cmp cmp) {
+    for (size_t i = sorted_end; i < end; i++) {
+        T x = std::move(a[i]);
+        size_t j = i;
+        for (; j > begin && cmp(x, a[j - 1]); j--)
+            a[j] = std::move(a[j - 1]);
+        a[j] = std::move(x);
+    }
+}
+
+// Returns the end of the run starting at begin, sorting it ascending if needed.
+template <typename T, typename Cmp>
+size_t next_run(T* a, size_t begin, size_t n, Cmp cmp) {
+    size_t end = begin + 1;
+    if (end == n)
+        return end;
+    if (cmp(a[end], a[begin])) {
+        // strictly descending only, so that reversing keeps the sort stable
+        while (end + 1 < n && cmp(a[end + 1], a[end]))
+            end++;
+        std::reverse(a + begin, a + end + 1);
+    } else {
+        while (end + 1 < n && !cmp(a[end + 1], a[end]))
+            end++;
+    }
+    end++;
+    if (end - begin < MIN_RUN) {
+        size_t forced = std::min(begin + MIN_RUN, n);
+        insertion_sort(a, begin, end, forced, cmp);
+        end = forced;
+    }
+    return end;
+}
+
+/**
+ * Merges sorted [lo, mid) and [mid, hi). The prefix of the left run that is already
+ * in place and the suffix of the right run are skipped, the rest of the left run
+ * goes to buf.
+ */
+template <typename T, typename Cmp>
+void merge(T* a, size_t lo, size_t mid, size_t hi, std::vector<T>& buf, Cmp cmp) {
+    lo = std::upper_bound(a + lo, a + mid, a[mid], cmp) - a;
+    if (lo == mid)
+        return;
+    hi = std::lower_bound(a + mid, a + hi, a[mid - 1], cmp) - a;
+    buf.assign(std::make_move_iterator(a + lo), std::make_move_iterator(a + mid));
+    size_t i = 0, j = mid, k = lo, left = buf.size();
+    while (i < left && j < hi)
+        a[k++] = cmp(a[j], buf[i]) ? std::move(a[j++]) : std::move(buf[i++]);
+    while (i < left)
+        a[k++] = std::move(buf[i++]);
+}
+
+// Powersort node power of the boundary between runs [b1, e1) and [e1, e2) in an array of n.
+inline int node_power(size_t b1, size_t e1, size_t e2, size_t n) {
+    uint64_t l = b1 + e1, r = e1 + e2, n2 = 2 * (uint64_t)n;   // doubled midpoints of both runs
+    int k = 0;
+    while (true) {
+        k++;
+        l *= 2;
+        r *= 2;
+        bool lb = l >= n2, rb = r >= n2;
+        if (lb != rb)
+            return k;
+        if (lb) {
+            l -= n2;
+            r -= n2;
+        }
+    }
+}
+
+} // namespace adaptive_detail
+
+template <typename T, typename Cmp = std::less<T>>
+void adaptive_sort(T* a, size_t n, Cmp cmp = Cmp()) {
+    using namespace adaptive_detail;
+    if (n < 2)
+        return;
+    struct Run {
+        size_t begin, end;
+        int power;
+    };
+    std::vector<Run> stack;
+    std::vector<T> buf;
+
+    size_t cur_begin = 0, cur_end = next_run(a, 0, n, cmp);
+    while (cur_end < n) {
+        size_t next_end = next_run(a, cur_end, n, cmp);
+        int p = node_power(cur_begin, cur_end, next_end, n);
+        while (!stack.empty() && stack.back().power > p) {
+            merge(a, stack.back().begin, stack.back().end, cur_end, buf, cmp);
+            cur_begin = stack.back().begin;
+            stack.pop_back();
+        }
+        stack.push_back(Run{cur_begin, cur_end, p});
+        cur_begin = cur_end;
+        cur_end = next_end;
+    }
+    while (!stack.empty()) {
+        merge(a, stack.back().begin, stack.back().end, n, buf, cmp);
+        stack.pop_back();
+    }
+}
+
+/**
+ * Sorted container fed by batches.
+ *
+ *     SortedBuffer<int> sb;
+ *     sb.append(batch.data(), batch.size());   // batch may be unsorted
+ *     sb.data();                               // always sorted
+ */
+template <typename T, typename Cmp = std::less<T>>
+class SortedBuffer {
+public:
+    explicit SortedBuffer(Cmp cmp = Cmp()) : cmp_(cmp) {}
+
+    void append(const T* batch, size_t n) {
+        size_t old = data_.size();
+        data_.insert(data_.end(), batch, batch + n);
+        merge_tail(old);
+    }
+
+    // Same as append(), for a batch the caller guarantees to be sorted.
+    void append_sorted(const T* batch, size_t n) {
+        size_t old = data_.size();
+        data_.insert(data_.end(), batch, batch + n);
+        merge_sorted_tail(old);
+    }
+
+    const std::vector<T>& data() const { return data_; }
+    size_t size() const { return data_.size(); }
+    void clear() { data_.clear(); }
+
+private:
+    std::vector<T> data_;
+    std::vector<T> buf_;
+    Cmp cmp_;
+
+    void merge_tail(size_t old) {
+        adaptive_sort(data_.data() + old, data_.size() - old, cmp_);   // O(n) for an ordered batch
+        merge_sorted_tail(old);
+    }
+
+    // Backward merge of the new tail into the buffer: only elements greater than the
+    // tail's first one are moved, all of them are at the end of the buffer.
+    void merge_sorted_tail(size_t old) {
+        if (old == 0 || old == data_.size() || !cmp_(data_[old], data_[old - 1]))
+            return;
+        T* a = data_.data();
+        buf_.assign(std::make_move_iterator(a + old), std::make_move_iterator(a + data_.size()));
+        size_t lo = std::upper_bound(a, a + old, buf_.front(), cmp_) - a;
+        size_t i = old, j = buf_.size(), k = data_.size();
+        while (i > lo && j > 0)
+            a[--k] = cmp_(buf_[j - 1], a[i - 1]) ? std::move(a[--i]) : std::move(buf_[--j]);
+        while (j > 0)
+            a[--k] = std::move(buf_[--j]);
+    }
+};
+
+#endif // ADAPTIVE_SORT_HPP
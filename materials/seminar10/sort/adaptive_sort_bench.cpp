@@ -0,0 +1,87 @@
+// Repeated-append workloads: re-sorting the whole buffer after every batch vs SortedBuffer
+// (see adaptive_sort.hpp).
+//
+// build: g++ -O2 -march=native adaptive_sort_bench.cpp -o adaptive_sort_bench
+// usage: ./adaptive_sort_bench [batches=200] [batch_size=10000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "adaptive_sort.hpp"
+
+using namespace std;
+
+// Batch generators, every call returns the next batch of a stream.
+struct Stream {
+    string name;
+    mt19937 rng{1};
+    uint32_t next = 0;
+
+    vector<uint32_t> batch(size_t n) {
+        vector<uint32_t> b(n);
+        if (name == "sorted") {              // time-ordered appends
+            for (auto& x : b)
+                x = next += rng() % 4;
+        } else if (name == "nearly") {       // ordered, 1% late arrivals from the recent past
+            for (auto& x : b) {
+                x = next += rng() % 4;
+                if (rng() % 100 == 0)
+                    x -= min<uint32_t>(x, rng() % (4 * n));
+            }
+        } else if (name == "reversed") {     // every batch descending, batches ascending
+            for (size_t i = 0; i < n; i++)
+                b[n - 1 - i] = next += rng() % 4;
+        } else {                             // random -- the worst case
+            for (auto& x : b)
+                x = rng();
+        }
+        return b;
+    }
+};
+
+template <typename F>
+static double run(const string& stream, size_t batches, size_t batch_size, F append) {
+    Stream s{stream};
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < batches; i++) {
+        vector<uint32_t> b = s.batch(batch_size);
+        append(b);
+    }
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    size_t batches = argc > 1 ? atoi(argv[1]) : 200;
+    size_t batch_size = argc > 2 ? atoi(argv[2]) : 10000;
+
+    printf("%-9s %14s %16s %16s %9s\n", "stream", "std::sort ms", "adaptive_sort ms",
+           "SortedBuffer ms", "speedup");
+    for (const string stream : {"sorted", "nearly", "reversed", "random"}) {
+        vector<uint32_t> v1, v2;
+        double full = run(stream, batches, batch_size, [&](const vector<uint32_t>& b) {
+            v1.insert(v1.end(), b.begin(), b.end());
+            sort(v1.begin(), v1.end());
+        });
+        double adaptive = run(stream, batches, batch_size, [&](const vector<uint32_t>& b) {
+            v2.insert(v2.end(), b.begin(), b.end());
+            adaptive_sort(v2.data(), v2.size());
+        });
+        SortedBuffer<uint32_t> sb;
+        double incremental = run(stream, batches, batch_size, [&](const vector<uint32_t>& b) {
+            sb.append(b.data(), b.size());
+        });
+        if (v1 != v2 || v1 != sb.data()) {
+            fprintf(stderr, "%s: results differ!\n", stream.c_str());
+            return 1;
+        }
+        printf("%-9s %14.1f %16.1f %16.1f %8.1fx\n", stream.c_str(), full, adaptive, incremental,
+               full / incremental);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Sorting of large records without moving them during the sort.
+//
+//   key_index_sort -- sorts compact (key, 32-bit index) pairs, then permutes records once
+//   argsort        -- sorts indices comparing keys through the index (no key copy)
+//   apply_permutation -- in-place cycle-following pass, every record is moved once
+//
+// Both sorts are stable with respect to equal keys.
+#ifndef INDIRECT_SORT_HPP
+#define INDIRECT_SORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename Key>
+struct KeyIndex {
+    Key key;
+    uint32_t idx;
+};
+
+/**
+ * Reorders a[] so that a[i] becomes old a[perm[i]].
+ * perm is consumed (it is used as a "done" marker), O(n) moves and one temporary per cycle.
+ */
+template <typename T>
+void apply_permutation(T* a, uint32_t* perm, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (perm[i] == i)
+            continue;
+        T tmp = std::move(a[i]);
+        size_t j = i;
+        while (perm[j] != i) {
+            size_t src = perm[j];
+            // the source of the next step is known one step ahead, hide its miss
+            __builtin_prefetch(&a[perm[src]]);
+            a[j] = std::move(a[src]);
+            perm[j] = j;
+            j = src;
+        }
+        a[j] = std::move(tmp);
+        perm[j] = j;
+    }
+}
+
+/**
+ * Returns the sorting permutation of a[] by key(a[i]).
+ * Sorts KeyIndex pairs -- sequential and compact, independent of sizeof(T).
+ */
+template <typename T, typename KeyFn>
+std::vector<uint32_t> key_index_permutation(const T* a, size_t n, KeyFn key) {
+    typedef decltype(key(a[0])) Key;
+    std::vector<KeyIndex<Key>> ki(n);
+    for (size_t i = 0; i < n; i++)
+        ki[i] = KeyIndex<Key>{key(a[i]), (uint32_t)i};
+    std::sort(ki.begin(), ki.end(), [](const KeyIndex<Key>& l, const KeyIndex<Key>& r) {
+        return l.key < r.key || (l.key == r.key && l.idx < r.idx);
+    });
+    std::vector<uint32_t> perm(n);
+    for (size_t i = 0; i < n; i++)
+        perm[i] = ki[i].idx;
+    return perm;
+}
+
+/**
+ * Returns the sorting permutation comparing keys through the index.
+ * Uses less memory than key_index_permutation, but every comparison is a random access.
+ */
+template <typename T, typename KeyFn>
+std::vector<uint32_t> argsort(const T* a, size_t n, KeyFn key) {
+    std::vector<uint32_t> perm(n);
+    for (size_t i = 0; i < n; i++)
+        perm[i] = (uint32_t)i;
+    std::sort(perm.begin(), perm.end(), [&](uint32_t l, uint32_t r) {
+        auto kl = key(a[l]), kr = key(a[r]);
+        return kl < kr || (kl == kr && l < r);
+    });
+    return perm;
+}
+
+template <typename T, typename KeyFn>
+void key_index_sort(T* a, size_t n, KeyFn key) {
+    std::vector<uint32_t> perm = key_index_permutation(a, n, key);
+    apply_permutation(a, perm.data(), n);
+}
+
+template <typename T, typename KeyFn>
+void argsort_sort(T* a, size_t n, KeyFn key) {
+    std::vector<uint32_t> perm = argsort(a, n, key);
+    apply_permutation(a, perm.data(), n);
+}
+
+#endif // INDIRECT_SORT_HPP
@@ -0,0 +1,75 @@
+// Direct sort of records vs key-index sort vs argsort (see indirect_sort.hpp).
+//
+// build: g++ -O2 -march=native indirect_sort_bench.cpp -o indirect_sort_bench
+// usage: ./indirect_sort_bench [total_mb=64]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "indirect_sort.hpp"
+
+using namespace std;
+
+template <size_t SIZE>
+struct Record {
+    uint64_t key;
+    char payload[SIZE - sizeof(uint64_t)];
+};
+
+// also checks that payloads travelled together with their keys
+template <typename Rec>
+static bool is_sorted_by_key(const vector<Rec>& v) {
+    for (size_t i = 0; i < v.size(); i++)
+        if ((i > 0 && v[i - 1].key > v[i].key) || v[i].payload[0] != (char)v[i].key)
+            return false;
+    return true;
+}
+
+template <typename Rec, typename Sort>
+static double measure(const vector<Rec>& input, Sort sort) {
+    vector<Rec> v = input;
+    auto t0 = chrono::steady_clock::now();
+    sort(v);
+    auto t1 = chrono::steady_clock::now();
+    if (!is_sorted_by_key(v)) {
+        fprintf(stderr, "not sorted!\n");
+        exit(1);
+    }
+    return chrono::duration<double, milli>(t1 - t0).count();
+}
+
+template <size_t SIZE>
+static void bench(size_t total_bytes) {
+    typedef Record<SIZE> Rec;
+    size_t n = total_bytes / SIZE;
+    mt19937_64 rng(SIZE);
+    vector<Rec> input(n);
+    for (auto& r : input) {
+        r.key = rng();
+        r.payload[0] = (char)r.key;
+    }
+    auto key = [](const Rec& r) { return r.key; };
+
+    double direct = measure(input, [](vector<Rec>& v) {
+        sort(v.begin(), v.end(), [](const Rec& l, const Rec& r) { return l.key < r.key; });
+    });
+    double ki = measure(input, [&](vector<Rec>& v) { key_index_sort(v.data(), v.size(), key); });
+    double as = measure(input, [&](vector<Rec>& v) { argsort_sort(v.data(), v.size(), key); });
+
+    printf("%6zu %10zu %12.1f %14.1f %12.1f %8.2fx\n", SIZE, n, direct, ki, as, direct / ki);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    size_t total = (argc > 1 ? atoi(argv[1]) : 64) * size_t(1 << 20);
+    printf("%6s %10s %12s %14s %12s %9s\n",
+           "bytes", "records", "direct ms", "key-index ms", "argsort ms", "speedup");
+    bench<64>(total);
+    bench<256>(total);
+    bench<1024>(total);
+    return 0;
+}
@@ -0,0 +1,51 @@
+// Filter chain template for run_experiment.py: @CONDITION@ is replaced by one ordering
+// of the predicates below joined with && (or ||), the result is built with different
+// compilers and optimization levels.
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "perf_counters.hpp"
+
+// expensive and almost always true, like check() in ../2_reordering.cpp
+__attribute__((noinline)) int check(unsigned x) {
+    unsigned h = x;
+    for (int i = 0; i < 64; i++)
+        h = h * 1103515245u + 12345u;
+    return (h >> 7) % 8 != 0;   // ~87% true
+}
+
+// cheap, 50% true, unpredictable on random data
+inline int odd(unsigned x) {
+    return x & 1;
+}
+
+// cheap, ~6% true
+inline int rare(unsigned x) {
+    return x % 16 == 0;
+}
+
+// cheap, ~94% true
+inline int often(unsigned x) {
+    return x % 16 != 0;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1 << 22;
+    std::vector<unsigned> data(n);
+    std::mt19937 rng(1);
+    for (auto& x : data)
+        x = rng();
+
+    PerfCounters pc;
+    long hits = 0;
+    pc.start();
+    for (unsigned x : data)
+        if (@CONDITION@)
+            hits++;
+    PerfCounters::Sample s = pc.stop();
+
+    PerfCounters::print_json(stdout, "@CONDITION@", s);
+    fprintf(stderr, "hits %ld\n", hits);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# Branch-order experiment: every ordering of the predicates in filter_template.cpp is built with
+# every compiler and optimization level, run several times and measured with PerfCounters
+# (../../seminar10/perf). Generalizes the manual "swap check() && (i%2), rebuild at -O0/-O2"
+# exercise of ../2_reordering.cpp.
+#
+# usage: python3 run_experiment.py [--predicates=check,odd,rare] [--op=&&] [--compilers=g++,clang++]
+#                                  [--opts=O0,O2] [--runs=5] [--n=4000000] [--csv=out.csv] [--build=build]
+import itertools
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+PERF_DIR = os.path.join(HERE, "..", "..", "seminar10", "perf")
+
+
+def parse_args():
+    args = {"predicates": "check,odd,rare", "op": "&&", "compilers": "g++,clang++", "opts": "O0,O2",
+            "runs": "5", "n": "4000000", "csv": "", "build": os.path.join(HERE, "build")}
+    for a in sys.argv[1:]:
+        if not a.startswith("--") or "=" not in a:
+            print("usage: run_experiment.py [--predicates=check,odd,rare] [--op=&&] [--compilers=g++,clang++]"
+                  " [--opts=O0,O2] [--runs=5] [--n=4000000] [--csv=out.csv] [--build=build]", file=sys.stderr)
+            sys.exit(2)
+        k, v = a[2:].split("=", 1)
+        if k not in args:
+            print("unknown option --%s" % k, file=sys.stderr)
+            sys.exit(2)
+        args[k] = v
+    return args
+
+
+def generate(template, predicates, op, build, orders=None, prefix="variant"):
+    """Writes one source per ordering (all permutations by default), returns [(condition, path)]."""
+    variants = []
+    for i, order in enumerate(orders if orders is not None else itertools.permutations(predicates)):
+        cond = (" %s " % op).join("%s(x)" % p for p in order)
+        path = os.path.join(build, "%s_%d.cpp" % (prefix, i))
+        with open(path, "w") as f:
+            f.write(template.replace("@CONDITION@", cond))
+        variants.append((cond, path))
+    return variants
+
+
+def run(binary, n, runs):
+    """Returns per-run JSON samples of PerfCounters; "hits" is taken from stderr."""
+    samples = []
+    for _ in range(runs):
+        res = subprocess.run([binary, str(n)], capture_output=True, text=True, check=True)
+        sample = json.loads(res.stdout.strip().splitlines()[-1])
+        sample["hits"] = int(res.stderr.split()[-1])
+        samples.append(sample)
+    return samples
+
+
+def build_and_run(cxx, opt, src, binary, n, runs):
+    subprocess.run([cxx, "-" + opt, "-std=c++17", "-I", PERF_DIR, src, "-o", binary], check=True)
+    return run(binary, n, runs)
+
+
+def median_of(samples, key):
+    vals = [s[key] for s in samples if s.get(key) is not None]
+    return statistics.median(vals) if vals else None
+
+
+def fmt(v, spec):
+    return ("%" + spec) % v if v is not None else "n/a"
+
+
+def main():
+    args = parse_args()
+    predicates = args["predicates"].split(",")
+    build = args["build"]
+    os.makedirs(build, exist_ok=True)
+    with open(os.path.join(HERE, "filter_template.cpp")) as f:
+        template = f.read()
+    variants = generate(template, predicates, args["op"], build)
+    compilers = [c for c in args["compilers"].split(",") if shutil.which(c)]
+    if not compilers:
+        print("no compiler found among %s" % args["compilers"], file=sys.stderr)
+        sys.exit(1)
+    n, runs = int(args["n"]), int(args["runs"])
+
+    # every predicate alone: cost and pass rate; the classic rule puts first the predicates that end the chain
+    # cheaply: the smallest cost / (1 - pass rate) for &&, where a failing predicate ends it, and the smallest
+    # cost / pass rate for ||, where a passing one does
+    if args["op"] == "||":
+        label, stop_rate = "cost/pass", lambda rate: rate
+    else:
+        label, stop_rate = "cost/(1-pass)", lambda rate: 1 - rate
+    singles = generate(template, [], args["op"], build, orders=[[p] for p in predicates], prefix="single")
+    print("%-8s %-4s %-10s %10s %10s %14s" % ("compiler", "opt", "predicate", "ns/elem", "pass rate", label))
+    for cxx in compilers:
+        for opt in args["opts"].split(","):
+            for (cond, src), p in zip(singles, predicates):
+                binary = os.path.join(build, "%s_%s_%s" % (os.path.basename(cxx), opt, p))
+                samples = build_and_run(cxx, opt, src, binary, n, runs)
+                ns = median_of(samples, "seconds") * 1e9 / n
+                rate = samples[0]["hits"] / n
+                rank = ns / stop_rate(rate) if stop_rate(rate) > 0 else float("inf")
+                print("%-8s %-4s %-10s %10.2f %10.3f %14.2f" % (cxx, opt, p, ns, rate, rank))
+    print()
+
+    rows = []
+    for cxx in compilers:
+        for opt in args["opts"].split(","):
+            group = []
+            for i, (cond, src) in enumerate(variants):
+                binary = os.path.join(build, "%s_%s_%d" % (os.path.basename(cxx), opt, i))
+                samples = build_and_run(cxx, opt, src, binary, n, runs)
+                sec = median_of(samples, "seconds")
+                group.append({"compiler": cxx, "opt": opt, "condition": cond,
+                              "ns_per_elem": sec * 1e9 / n,
+                              "ipc": median_of(samples, "ipc"),
+                              "branch_miss_rate": median_of(samples, "branch_miss_rate"),
+                              "branch_misses_per_elem": (median_of(samples, "branch_misses") / n
+                                                         if median_of(samples, "branch_misses") is not None
+                                                         else None)})
+            best = min(r["ns_per_elem"] for r in group)
+            for r in group:
+                r["vs_best"] = r["ns_per_elem"] / best
+            rows += sorted(group, key=lambda r: r["ns_per_elem"])
+
+    print("%-8s %-4s %-34s %10s %8s %6s %10s %12s" % ("compiler", "opt", "condition", "ns/elem",
+                                                    "vs best", "ipc", "miss rate", "misses/elem"))
+    for r in rows:
+        print("%-8s %-4s %-34s %10.2f %7.2fx %6s %10s %12s"
+              % (r["compiler"], r["opt"], r["condition"], r["ns_per_elem"], r["vs_best"],
+                 fmt(r["ipc"], ".2f"), fmt(r["branch_miss_rate"], ".4f"),
+                 fmt(r["branch_misses_per_elem"], ".3f")))
+    if args["csv"]:
+        keys = ["compiler", "opt", "condition", "ns_per_elem", "vs_best", "ipc", "branch_miss_rate",
+                "branch_misses_per_elem"]
+        with open(args["csv"], "w") as f:
+            f.write(",".join(keys) + "\n")
+            for r in rows:
+                f.write(",".join('"%s"' % r[k] if k == "condition" else
+                                 ("" if r[k] is None else str(r[k])) for k in keys) + "\n")
+
+
+if __name__ == "__main__":
+    main()
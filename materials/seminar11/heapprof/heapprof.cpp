@@ -0,0 +1,392 @@
+// Sampling heap profiler, see readme.md.
+//
+// malloc/calloc/realloc/free and the aligned variants are interposed and forwarded to glibc
+// (__libc_malloc & co., no dlsym bootstrap problem). Allocations are sampled by bytes, Poisson
+// process like tcmalloc: every thread counts down an exponentially distributed number of bytes
+// (mean HEAPPROF_RATE), the allocation that crosses zero is sampled. A sampled allocation of size s
+// stands for 1 / (1 - exp(-s / rate)) allocations of its size, which makes all totals unbiased.
+// The fast path is a thread-local subtraction; free() looks up a small lock-free table of live
+// sampled pointers, and only while there are any.
+//
+// build:   g++ -O2 -fPIC -shared heapprof.cpp -o libheapprof.so -ldl
+// profile: g++ -O2 -fno-omit-frame-pointer -rdynamic prog.cpp -o prog
+//          HEAPPROF_OUT=prog.heap HEAPPROF_RATE=524288 LD_PRELOAD=./libheapprof.so ./prog
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <execinfo.h>
+#include <time.h>
+
+#include "../sampler/symbolize.h"
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+}
+
+namespace {
+
+const int MAX_DEPTH = 32;
+const int TABLE_BITS = 20;
+const size_t TABLE_SLOTS = 1 << TABLE_BITS;   // live sampled allocations, 24 MiB, pages touched on use
+const uintptr_t EMPTY = 0;
+const uintptr_t TOMBSTONE = 1;
+
+// Estimated totals of one allocation site (stack).
+struct Site {
+    double allocs = 0, bytes = 0;              // allocated
+    double frees = 0, freed_bytes = 0;         // of those, freed
+    uint64_t samples = 0;
+};
+
+struct Slot {
+    std::atomic<uintptr_t> ptr;
+    uint32_t site;
+    uint32_t size;                             // capped, only used for the weight
+    double weight;                             // allocations this sample stands for
+};
+
+bool g_enabled = false;
+double g_rate = 512 * 1024;
+const char* g_out = nullptr;
+uint64_t g_start_ns = 0;
+
+Slot* g_table = nullptr;                       // from __libc_calloc at start, never freed
+std::atomic<int64_t> g_live_samples{0};
+std::atomic<uint64_t> g_table_full{0};
+
+// Sites: stacks -> index, under a spinlock; only sampled allocations and frees get here.
+std::atomic_flag g_sites_lock = ATOMIC_FLAG_INIT;
+std::map<std::vector<uintptr_t>, uint32_t>* g_site_ids = nullptr;
+std::vector<Site>* g_sites = nullptr;
+std::vector<const std::vector<uintptr_t>*>* g_site_stacks = nullptr;
+
+__thread int64_t tls_countdown __attribute__((tls_model("initial-exec")));
+__thread uint64_t tls_rng __attribute__((tls_model("initial-exec")));
+__thread bool tls_started __attribute__((tls_model("initial-exec")));
+__thread bool tls_inside __attribute__((tls_model("initial-exec")));
+
+uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Next gap between samples in bytes, exponential with mean g_rate.
+int64_t next_gap() {
+    if (g_rate <= 1)
+        return 1;   // every allocation
+    if (tls_rng == 0)
+        tls_rng = (now_ns() ^ ((uintptr_t)&tls_rng * 0x9E3779B97F4A7C15ULL)) | 1;
+    tls_rng ^= tls_rng << 13;   // xorshift64
+    tls_rng ^= tls_rng >> 7;
+    tls_rng ^= tls_rng << 17;
+    double u = ((tls_rng >> 11) + 0.5) / 9007199254740992.0;   // (0, 1)
+    return (int64_t)(-std::log(u) * g_rate) + 1;
+}
+
+size_t slot_of(uintptr_t p) {
+    return (p >> 4) * 0x9E3779B97F4A7C15ULL >> (64 - TABLE_BITS);
+}
+
+void lock_sites() {
+    while (g_sites_lock.test_and_set(std::memory_order_acquire))
+        ;
+}
+
+void unlock_sites() {
+    g_sites_lock.clear(std::memory_order_release);
+}
+
+// What a table slot holds about one sampled allocation
+struct Sample {
+    uint32_t site;
+    uint32_t size;
+    double weight;
+};
+
+void put_sample(void* p, const Sample& sample) {
+    size_t i = slot_of((uintptr_t)p);
+    for (size_t probe = 0; probe < 64; probe++, i = (i + 1) & (TABLE_SLOTS - 1)) {
+        uintptr_t cur = g_table[i].ptr.load(std::memory_order_relaxed);
+        if ((cur == EMPTY || cur == TOMBSTONE) &&
+            g_table[i].ptr.compare_exchange_strong(cur, TOMBSTONE, std::memory_order_acquire)) {
+            // reserved (still a tombstone for lookups), fill in and publish
+            g_table[i].site = sample.site;
+            g_table[i].size = sample.size;
+            g_table[i].weight = sample.weight;
+            g_table[i].ptr.store((uintptr_t)p, std::memory_order_release);
+            g_live_samples.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    g_table_full.fetch_add(1, std::memory_order_relaxed);   // counted as allocated, never as freed
+}
+
+// Removes the sample of p from the table, if p was sampled.
+bool take_sample(void* p, Sample& out) {
+    if (!p || g_live_samples.load(std::memory_order_relaxed) == 0)
+        return false;
+    size_t i = slot_of((uintptr_t)p);
+    for (size_t probe = 0; probe < 64; probe++, i = (i + 1) & (TABLE_SLOTS - 1)) {
+        uintptr_t cur = g_table[i].ptr.load(std::memory_order_acquire);
+        if (cur == EMPTY)
+            return false;
+        if (cur != (uintptr_t)p)
+            continue;
+        out = Sample{g_table[i].site, g_table[i].size, g_table[i].weight};
+        if (!g_table[i].ptr.compare_exchange_strong(cur, TOMBSTONE))
+            return false;
+        g_live_samples.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void count_free(const Sample& sample) {
+    lock_sites();
+    (*g_sites)[sample.site].frees += sample.weight;
+    (*g_sites)[sample.site].freed_bytes += sample.weight * sample.size;
+    unlock_sites();
+}
+
+__attribute__((noinline)) void record_alloc(void* p, size_t size) {
+    tls_inside = true;   // allocations made here (backtrace, maps) are not sampled
+    void* frames[MAX_DEPTH + 2];
+    int n = backtrace(frames, MAX_DEPTH + 2);
+    // frames[0] is record_alloc, frames[1] the interposed function
+    std::vector<uintptr_t> stack;
+    for (int i = 2; i < n; i++)
+        stack.push_back((uintptr_t)frames[i] - 1);
+    double weight = g_rate <= 1 ? 1.0 : 1.0 / (1.0 - std::exp(-(double)size / g_rate));
+
+    lock_sites();
+    auto it = g_site_ids->emplace(std::move(stack), (uint32_t)g_sites->size()).first;
+    if (it->second == g_sites->size()) {
+        g_sites->emplace_back();
+        g_site_stacks->push_back(&it->first);
+    }
+    uint32_t site = it->second;
+    Site& s = (*g_sites)[site];
+    s.samples++;
+    s.allocs += weight;
+    s.bytes += weight * size;
+    unlock_sites();
+
+    put_sample(p, Sample{site, (uint32_t)std::min<size_t>(size, UINT32_MAX), weight});
+    tls_inside = false;
+}
+
+inline void on_alloc(void* p, size_t size) {
+    if (!p || !g_enabled || tls_inside)
+        return;
+    tls_countdown -= (int64_t)size;
+    if (__builtin_expect(tls_countdown > 0, 1))
+        return;
+    if (!tls_started) {   // the countdown of a new thread starts at a random point too
+        tls_started = true;
+        tls_countdown += next_gap();
+        if (tls_countdown > 0)
+            return;
+    }
+    // memoryless: the next sample point after this allocation is again an exponential gap away
+    tls_countdown = next_gap();
+    record_alloc(p, size);
+}
+
+inline void on_free(void* p) {
+    Sample sample;
+    if (take_sample(p, sample))
+        count_free(sample);
+}
+
+// Allocation wrappers are not the call site: the first frame outside them is.
+bool is_allocator(const std::string& name) {
+    return name.compare(0, 12, "operator new") == 0 || name.compare(0, 6, "malloc") == 0 ||
+           name.compare(0, 6, "calloc") == 0 || name.compare(0, 7, "realloc") == 0 ||
+           name.find("allocator") != std::string::npos;
+}
+
+void write_report() {
+    g_enabled = false;
+    tls_inside = true;
+    double seconds = (now_ns() - g_start_ns) / 1e9;
+    lock_sites();
+    std::vector<Site> sites(*g_sites);
+    std::vector<const std::vector<uintptr_t>*> stacks(*g_site_stacks);
+    unlock_sites();
+
+    std::unordered_map<uintptr_t, std::string> names;
+    auto name_of = [&](uintptr_t pc) -> const std::string& {
+        auto it = names.find(pc);
+        if (it == names.end())
+            it = names.emplace(pc, symbols::symbolize(pc)).first;
+        return it->second;
+    };
+    // sites with the same symbolized call chain are merged
+    std::map<std::string, Site> merged;
+    std::map<std::string, std::string> folded_of;
+    for (size_t i = 0; i < sites.size(); i++) {
+        const std::vector<uintptr_t>& st = *stacks[i];
+        std::string site, folded;
+        int shown = 0;
+        for (uintptr_t pc : st) {
+            const std::string& name = name_of(pc);
+            if (shown < 4 && (shown > 0 || !is_allocator(name))) {
+                site += (shown ? " <- " : "") + name;
+                shown++;
+            }
+        }
+        for (auto it = st.rbegin(); it != st.rend(); ++it)
+            folded += (folded.empty() ? "" : ";") + name_of(*it);
+        Site& m = merged[site];
+        m.allocs += sites[i].allocs;
+        m.bytes += sites[i].bytes;
+        m.frees += sites[i].frees;
+        m.freed_bytes += sites[i].freed_bytes;
+        m.samples += sites[i].samples;
+        folded_of[site] = folded;
+    }
+    std::vector<std::pair<std::string, Site>> order(merged.begin(), merged.end());
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<std::string, Site>& a, const std::pair<std::string, Site>& b) {
+                  return a.second.bytes > b.second.bytes;
+              });
+
+    FILE* out = fopen(g_out, "w");
+    if (!out) {
+        perror(g_out);
+        return;
+    }
+    double total = 0, live = 0;
+    for (auto& s : order) {
+        total += s.second.bytes;
+        live += s.second.bytes - s.second.freed_bytes;
+    }
+    fprintf(out, "# heapprof: rate %.0f bytes, %.3f s, allocated %.0f bytes (%.1f MB/s), live at exit %.0f bytes\n",
+            g_rate, seconds, total, total / 1e6 / std::max(seconds, 1e-9), live);
+    if (uint64_t lost = g_table_full.load())
+        fprintf(out, "# %llu sampled allocations not tracked (table full), their frees are missing\n",
+                (unsigned long long)lost);
+    fprintf(out, "%8s %14s %12s %12s %14s %14s %10s  %s\n", "samples", "alloc bytes", "allocs", "MB/s",
+            "live bytes", "churn bytes", "live objs", "site");
+    for (auto& s : order) {
+        const Site& x = s.second;
+        // churn: allocated and already freed again -- temporary objects
+        fprintf(out, "%8llu %14.0f %12.0f %12.3f %14.0f %14.0f %10.0f  %s\n", (unsigned long long)x.samples,
+                x.bytes, x.allocs, x.bytes / 1e6 / std::max(seconds, 1e-9), x.bytes - x.freed_bytes,
+                x.freed_bytes, x.allocs - x.frees, s.first.c_str());
+    }
+    fclose(out);
+
+    // allocated bytes per stack, for folded2dot.py / flame graphs
+    std::string folded_path = std::string(g_out) + ".folded";
+    if (FILE* f = fopen(folded_path.c_str(), "w")) {
+        for (auto& s : order)
+            fprintf(f, "%s %.0f\n", folded_of[s.first].c_str(), s.second.bytes);
+        fclose(f);
+    }
+}
+
+__attribute__((constructor)) void heapprof_init() {
+    g_out = getenv("HEAPPROF_OUT");
+    if (!g_out)
+        return;
+    if (const char* rate = getenv("HEAPPROF_RATE"))
+        g_rate = std::max(1.0, atof(rate));
+    tls_inside = true;
+    void* frame;
+    backtrace(&frame, 1);   // loads libgcc_s now, not inside the first sampled malloc
+    g_table = (Slot*)__libc_calloc(TABLE_SLOTS, sizeof(Slot));
+    g_site_ids = new std::map<std::vector<uintptr_t>, uint32_t>;
+    g_sites = new std::vector<Site>;
+    g_site_stacks = new std::vector<const std::vector<uintptr_t>*>;
+    tls_inside = false;
+    if (!g_table)
+        return;
+    g_start_ns = now_ns();
+    g_enabled = true;
+    atexit(write_report);
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    on_alloc(p, size);
+    return p;
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    on_alloc(p, n * size);
+    return p;
+}
+
+void* realloc(void* old, size_t size) {
+    if (old && size == 0) {   // glibc frees the block and returns NULL
+        free(old);
+        return nullptr;
+    }
+    // the sample of old leaves the table before glibc releases old: once released, another thread may get the
+    // address and have it sampled
+    Sample sample;
+    bool sampled = take_sample(old, sample);
+    void* p = __libc_realloc(old, size);
+    if (!p) {   // failed: old is still allocated
+        if (sampled)
+            put_sample(old, sample);
+        return nullptr;
+    }
+    if (sampled)
+        count_free(sample);
+    on_alloc(p, size);
+    return p;
+}
+
+void free(void* p) {
+    on_free(p);
+    __libc_free(p);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    on_alloc(p, size);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* p = memalign(alignment, size);
+    if (!p)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,30 @@
+// Validation workload for heapprof: copies of the String of ../../seminar4/move_sem_1.cpp.
+// String has a defaulted destructor, so every copy leaks its buffer; moves allocate nothing.
+//   g++ -O2 -fno-omit-frame-pointer -rdynamic string_copies.cpp -o string_copies
+//   HEAPPROF_OUT=sc.heap LD_PRELOAD=./libheapprof.so ./string_copies 100000 > /dev/null
+#include <cstdlib>
+
+#define main move_sem_1_main
+#include "../../seminar4/move_sem_1.cpp"
+#undef main
+
+__attribute__((noinline)) void copies(const String& s, int n) {
+    for (int i = 0; i < n; i++)
+        f(s);   // String(const String&): new char[64]
+}
+
+__attribute__((noinline)) void moves(int n) {
+    String s("0123456789012345678901234567890123456789012345678901234567890123");
+    for (int i = 0; i < n; i++) {
+        String t(std::move(s));   // steals the buffer
+        s = std::move(t);         // Operator=&& frees s's (empty) buffer, steals t's
+    }
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    String s("0123456789012345678901234567890123456789012345678901234567890123");   // 64 characters
+    copies(s, n);
+    moves(n);
+    return 0;
+}
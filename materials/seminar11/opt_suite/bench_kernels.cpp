@@ -0,0 +1,79 @@
+// Run-time half of the optimization suite: bench.hpp benchmarks of kernels.cpp and,
+// with --insns, retired instructions per call measured with PerfCounters.
+//   g++ -O2 -std=c++17 -I../../seminar10/bench -I../../seminar10/perf kernels.cpp bench_kernels.cpp -o bench_kernels
+//   ./bench_kernels [bench.hpp options] | ./bench_kernels --insns
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "bench.hpp"
+#include "perf_counters.hpp"
+#include "kernels.h"
+
+static const int N = 4096;
+
+struct Inputs {
+    std::vector<int> ints = std::vector<int>(N, 3);
+    std::vector<int> out = std::vector<int>(N, 0);
+    std::vector<Square> squares = std::vector<Square>(N);
+    int scalar = 5;
+};
+
+static Inputs& inputs() {
+    static Inputs in;
+    return in;
+}
+
+// kernel name as in kernels.cpp -> one call with fixed inputs
+struct Kernel {
+    const char* name;
+    void (*call)();
+};
+
+static const Kernel KERNELS[] = {
+    {"pure_call_discarded", [] { bench::do_not_optimize(pure_call_discarded()); }},
+    {"pure_call_invariant", [] { bench::do_not_optimize(pure_call_invariant(N, 11)); }},
+    {"constant_sum", [] { bench::do_not_optimize(constant_sum()); }},
+    {"div_by_const", [] { bench::do_not_optimize(div_by_const(123456789u)); }},
+    {"sum_ints", [] { bench::do_not_optimize(sum_ints(inputs().ints.data(), N)); }},
+    {"add_scalar_restrict", [] { add_scalar_restrict(inputs().out.data(), &inputs().scalar, N); }},
+    {"add_scalar_alias", [] { add_scalar_alias(inputs().out.data(), &inputs().scalar, N); }},
+    {"area_final", [] { bench::do_not_optimize(area_final(inputs().squares.data(), N)); }},
+    {"area_local", [] { bench::do_not_optimize(area_local(7, N)); }},
+};
+
+static void run_kernel(bench::State& st) {
+    const Kernel& k = KERNELS[st.arg()];
+    while (st.keep_running())
+        k.call();
+}
+
+static bool register_kernels() {
+    for (size_t i = 0; i < sizeof(KERNELS) / sizeof(KERNELS[0]); i++)
+        bench::registry().push_back({KERNELS[i].name, run_kernel, (long)i});
+    return true;
+}
+
+// "name insns_per_call" lines, "name n/a" when the counters are unavailable
+static int count_instructions() {
+    const int CALLS = 1000;
+    PerfCounters pc;
+    for (const Kernel& k : KERNELS) {
+        k.call();   // warm up (page faults of the inputs)
+        pc.start();
+        for (int i = 0; i < CALLS; i++)
+            k.call();
+        PerfCounters::Sample s = pc.stop();
+        if (s.valid[PerfCounters::INSTRUCTIONS])
+            printf("%s %.1f\n", k.name, (double)s.value[PerfCounters::INSTRUCTIONS] / CALLS);
+        else
+            printf("%s n/a\n", k.name);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--insns") == 0)
+        return count_instructions();
+    register_kernels();
+    return bench::run_all(argc, argv);
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+# Optimization regression suite: builds kernels.cpp with every compiler and optimization level,
+# checks the "// EXPECT:" lines of kernels.cpp against the generated assembly and the retired
+# instruction counts (bench_kernels --insns), then optionally runs the benchmarks.
+# A toolchain upgrade that loses one of the optimizations makes the script exit with 1.
+#
+# usage: python3 check_opt.py [--compilers=g++,clang++] [--opts=O2,O3] [--flags="-march=native"]
+#                             [--bench=0|1] [--build=build]
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+INCLUDES = ["-I", os.path.join(HERE, "..", "..", "seminar10", "bench"),
+            "-I", os.path.join(HERE, "..", "..", "seminar10", "perf")]
+EXPECT_RE = re.compile(r"^// EXPECT(?:\[(\w+)\])?: (.*)$")
+FUNC_RE = re.compile(r"^[A-Za-z_][\w\s\*&:<>]*?\b(\w+)\s*\(")
+
+
+def parse_args():
+    args = {"compilers": "g++,clang++", "opts": "O2,O3", "flags": "", "bench": "0",
+            "build": os.path.join(HERE, "build")}
+    for a in sys.argv[1:]:
+        if not a.startswith("--") or "=" not in a or a[2:].split("=", 1)[0] not in args:
+            print("usage: check_opt.py [--compilers=g++,clang++] [--opts=O2,O3] [--flags=...]"
+                  " [--bench=0|1] [--build=build]", file=sys.stderr)
+            sys.exit(2)
+        k, v = a[2:].split("=", 1)
+        args[k] = v
+    return args
+
+
+def read_expectations(path):
+    """Returns {function: [(level or None, expectation)]} from the EXPECT lines above each function."""
+    result, pending = {}, []
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip()
+            m = EXPECT_RE.match(line)
+            if m:
+                pending.append((m.group(1), m.group(2).strip()))
+                continue
+            m = FUNC_RE.match(line)
+            if m and pending:
+                result[m.group(1)] = pending
+                pending = []
+    return result
+
+
+def functions(asm_path, names):
+    """Returns {function: (instruction lines, {local label: index of the instruction after it})}
+    for the given (extern "C") functions."""
+    bodies, current = {}, None
+    with open(asm_path) as f:
+        for line in f:
+            text = line.strip()
+            label = re.match(r"^_?(\w+):", line)
+            if label and label.group(1) in names:
+                current = label.group(1)
+                bodies[current] = ([], {})
+                continue
+            if current is None:
+                continue
+            local = re.match(r"^(\.?L\w+):", text)
+            if local:
+                insns, labels = bodies[current]
+                labels[local.group(1)] = len(insns)
+            elif label:
+                continue
+            elif text.startswith(".size") or text.startswith(".cfi_endproc") or text.startswith(".section"):
+                current = None
+            elif text and not text.startswith(".") and not text.startswith("#") and not text.startswith(";"):
+                bodies[current][0].append(" ".join(text.split()))
+    return bodies
+
+
+def is_call(insn):
+    mnemonic, _, operand = insn.partition(" ")
+    if mnemonic.startswith("call"):
+        return True
+    # tail call: jmp to a symbol or through a register, not to a local label
+    return mnemonic.startswith("jmp") and not operand.startswith(".L") and not operand.startswith("LBB")
+
+
+def is_indirect(insn):
+    mnemonic, _, operand = insn.partition(" ")
+    return (mnemonic.startswith("call") or mnemonic.startswith("jmp")) and operand.startswith("*")
+
+
+def calls_in_loops(body, labels):
+    """Calls between a local label and a later jump back to it, i.e. inside a loop."""
+    found = []
+    for j, insn in enumerate(body):
+        mnemonic, _, operand = insn.partition(" ")
+        start = labels.get(operand)
+        if mnemonic.startswith("j") and start is not None and start <= j:
+            found += [i for i in body[start:j] if is_call(i) and i not in found]
+    return found
+
+
+def check_static(expectation, function):
+    """Returns None if the expectation holds, otherwise the reason."""
+    body, labels = function
+    m = re.match(r"^(no-call|no-indirect-call|no-call-in-loop|calls <= (\d+)|max-insns (\d+)|has (.+)|lacks (.+))$",
+                 expectation)
+    if not m:
+        return None if expectation.startswith("insns/call") else "unknown expectation"
+    calls = [i for i in body if is_call(i)]
+    if expectation == "no-call-in-loop":
+        in_loops = calls_in_loops(body, labels)
+        return None if not in_loops else "in a loop: %s" % "; ".join(in_loops)
+    if expectation == "no-call":
+        return None if not calls else "calls: %s" % "; ".join(calls)
+    if expectation == "no-indirect-call":
+        indirect = [i for i in body if is_indirect(i)]
+        return None if not indirect else "indirect: %s" % "; ".join(indirect)
+    if m.group(2):
+        return None if len(calls) <= int(m.group(2)) else "%d calls" % len(calls)
+    if m.group(3):
+        return None if len(body) <= int(m.group(3)) else "%d instructions" % len(body)
+    if m.group(4):
+        return None if any(re.search(m.group(4), i) for i in body) else "no instruction matches"
+    bad = [i for i in body if re.search(m.group(5), i)]
+    return None if not bad else "found: %s" % "; ".join(bad)
+
+
+def check_runtime(expectation, insns):
+    m = re.match(r"^insns/call <= (\d+)$", expectation)
+    if not m:
+        return None
+    if insns is None:
+        return "skipped"
+    return None if insns <= int(m.group(1)) else "%.1f instructions per call" % insns
+
+
+def main():
+    args = parse_args()
+    expectations = read_expectations(os.path.join(HERE, "kernels.cpp"))
+    compilers = [c for c in args["compilers"].split(",") if shutil.which(c)]
+    if not compilers:
+        print("no compiler found among %s" % args["compilers"], file=sys.stderr)
+        sys.exit(1)
+    os.makedirs(args["build"], exist_ok=True)
+    flags = shlex.split(args["flags"])
+    failures = 0
+    for cxx in compilers:
+        for opt in args["opts"].split(","):
+            tag = "%s_%s" % (os.path.basename(cxx), opt)
+            asm = os.path.join(args["build"], "kernels_%s.s" % tag)
+            binary = os.path.join(args["build"], "bench_kernels_%s" % tag)
+            common = [cxx, "-" + opt, "-std=c++17", "-fno-asynchronous-unwind-tables"] + flags + INCLUDES
+            subprocess.run(common + ["-S", os.path.join(HERE, "kernels.cpp"), "-o", asm], check=True)
+            subprocess.run(common + [os.path.join(HERE, "kernels.cpp"), os.path.join(HERE, "bench_kernels.cpp"),
+                                     "-o", binary], check=True)
+            insns = {}
+            out = subprocess.run([binary, "--insns"], capture_output=True, text=True, check=True).stdout
+            for line in out.splitlines():
+                name, value = line.split()
+                insns[name] = None if value == "n/a" else float(value)
+
+            bodies = functions(asm, set(expectations))
+            print("== %s -%s %s" % (cxx, opt, " ".join(flags)))
+            for fn, items in expectations.items():
+                for level, e in items:
+                    if level and level != opt:
+                        continue
+                    if fn not in bodies:
+                        reason = "function not found in %s" % asm
+                    else:
+                        reason = check_static(e, bodies[fn]) or check_runtime(e, insns.get(fn))
+                    status = "ok" if reason is None else ("SKIP" if reason == "skipped" else "FAIL")
+                    failures += status == "FAIL"
+                    print("  %-4s %-22s %-24s %s" % (status, fn, e, reason or ""))
+            if args["bench"] == "1":
+                subprocess.run([binary, "--min-time=0.2", "--samples=10"], check=True)
+    print("%d failure(s)" % failures)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
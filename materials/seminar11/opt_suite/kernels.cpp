@@ -0,0 +1,114 @@
+// Kernels with the optimization each one must get at -O2.
+// Expectations are the "// EXPECT:" lines right above a function, checked by check_opt.py
+// against the generated assembly:
+//   no-call              no direct or indirect call left
+//   no-indirect-call     no call/jmp through a register or memory (devirtualized)
+//   calls <= N           at most N call instructions
+//   no-call-in-loop      no call between a label and a jump back to it (calls were hoisted out of loops)
+//   max-insns N          at most N instructions in the function
+//   has REGEX            some instruction matches REGEX
+//   lacks REGEX          no instruction matches REGEX
+//   insns/call <= N      runtime: at most N retired instructions per call (PerfCounters, bench_kernels --insns)
+// "// EXPECT[O3]:" applies only when the suite is checked at -O3 (GCC does not vectorize these loops at -O2).
+#include "kernels.h"
+
+// a() of ../1.cpp
+static int a() {
+    long k = 0;
+    for (int i = 0; i < 523; i++)
+        k = 1 + i + k / 365;
+    return k;
+}
+
+// main() of ../1.cpp: the result is unused and a() has no side effects, so the loop is dead.
+// EXPECT: no-call
+// EXPECT: max-insns 2
+// EXPECT: insns/call <= 10
+int pure_call_discarded() {
+    for (int i = 0; i < 1024 * 1024; i++) {
+        if (i % 2)
+            a();
+    }
+    return 0;
+}
+
+__attribute__((noinline, const)) int weight(int x) {
+    return x * 7 + 3;
+}
+
+// const function with a loop-invariant argument: one call, hoisted out of the loop
+// (and the loop becomes a multiplication). "calls <= 1" alone would also pass with the call left in the loop.
+// EXPECT: calls <= 1
+// EXPECT: no-call-in-loop
+// EXPECT: insns/call <= 40
+int pure_call_invariant(int n, int x) {
+    int s = 0;
+    for (int i = 0; i < n; i++)
+        s += weight(x);
+    return s;
+}
+
+// Sum 1..1000: folded to a constant.
+// EXPECT: max-insns 2
+// EXPECT: has mov.*\$500500
+int constant_sum() {
+    int s = 0;
+    for (int i = 1; i <= 1000; i++)
+        s += i;
+    return s;
+}
+
+// Division by a constant: multiplication by the reciprocal, no div.
+// EXPECT: lacks ^i?div
+// EXPECT: no-call
+unsigned div_by_const(unsigned x) {
+    return x / 10;
+}
+
+// Integer reduction: vectorized (integer addition is associative, unlike float).
+// EXPECT[O3]: has ^v?paddd
+int sum_ints(const int* v, int n) {
+    int s = 0;
+    for (int i = 0; i < n; i++)
+        s += v[i];
+    return s;
+}
+
+// With restrict *b is loaded once and the loop is vectorized.
+// EXPECT[O3]: has ^v?paddd
+// EXPECT: no-call
+void add_scalar_restrict(int* __restrict a, const int* __restrict b, int n) {
+    for (int i = 0; i < n; i++)
+        a[i] += *b;
+}
+
+// Without restrict a[i] may be *b: the loop is either scalar with *b reloaded after every store
+// or vectorized behind a run-time overlap check. No expectation, it is the baseline
+// the restrict version is compared with in bench_kernels.
+void add_scalar_alias(int* a, const int* b, int n) {
+    for (int i = 0; i < n; i++)
+        a[i] += *b;
+}
+
+// Square is final: the virtual call through Square* is direct and inlined.
+// EXPECT: no-indirect-call
+// EXPECT: no-call
+int area_final(const Square* sq, int n) {
+    int s = 0;
+    for (int i = 0; i < n; i++)
+        s += sq[i].area();
+    return s;
+}
+
+// The dynamic type is known at the call through Shape&: devirtualized and inlined.
+// EXPECT: no-indirect-call
+// EXPECT: no-call
+int area_local(int side, int n) {
+    Square sq;
+    sq.side = side;
+    const Shape& sh = sq;
+    int s = 0;
+    for (int i = 0; i < n; i++)
+        s += sh.area();
+    return s;
+}
@@ -0,0 +1,32 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// Kernels of the optimization regression suite, see readme.md.
+// Definitions are in kernels.cpp: a separate translation unit, so callers can not
+// constant-propagate their arguments and the code checked by check_opt.py is the code benchmarked.
+
+struct Shape {
+    virtual ~Shape() = default;
+    virtual int area() const = 0;
+};
+
+struct Square final : Shape {
+    int side = 0;
+    int area() const override { return side * side; }
+};
+
+extern "C" {
+
+int pure_call_discarded();
+int pure_call_invariant(int n, int x);
+int constant_sum();
+unsigned div_by_const(unsigned x);
+int sum_ints(const int* v, int n);
+void add_scalar_restrict(int* __restrict a, const int* __restrict b, int n);
+void add_scalar_alias(int* a, const int* b, int n);
+int area_final(const Square* sq, int n);
+int area_local(int side, int n);
+
+}
+
+#endif
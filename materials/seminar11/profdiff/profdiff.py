@@ -0,0 +1,335 @@
+#!/usr/bin/env python3
+# Difference of two sets of profiles (e.g. -O0 vs -O2 builds, or two commits).
+#
+# usage: python3 profdiff.py -a base1.folded base2.folded ... -b new1.folded new2.folded ...
+#                            [--svg=diff.svg] [--threshold=5] [--alpha=0.05] [--normalize] [--top=30]
+#
+# Inputs are folded stacks (sampler/, flamegraph tools) or callgrind files (valgrind, tracer/),
+# detected by content. Several files per side are repeated runs: per-function inclusive and
+# exclusive costs are compared with Welch's t-test. Exit code is 1 if some function became slower
+# by more than --threshold percent of the total with p < --alpha, so the tool can gate CI.
+import math
+import re
+import sys
+from collections import defaultdict
+
+
+# ---------------------------------------------------------------- parsing
+
+class Profile:
+    def __init__(self):
+        self.inclusive = defaultdict(float)
+        self.exclusive = defaultdict(float)
+        self.stacks = defaultdict(float)   # "a;b;c" -> exclusive cost of the leaf, for flame graphs
+        self.total = 0.0
+
+
+def parse_folded(lines):
+    p = Profile()
+    for line in lines:
+        line = line.rstrip("\n")
+        if not line.strip():
+            continue
+        frames, count = line.rsplit(" ", 1)
+        count = float(count)
+        fs = frames.split(";")
+        for fn in set(fs):
+            p.inclusive[fn] += count
+        p.exclusive[fs[-1]] += count
+        p.stacks[frames] += count
+        p.total += count
+    return p
+
+
+# callgrind numbers compressed names per kind: "fn=(5)" and "fl=(5)" are different names
+NAME_SPACES = {"fn": "fn", "cfn": "fn", "fl": "fl", "fi": "fl", "fe": "fl", "cfl": "fl", "cfi": "fl",
+               "ob": "ob", "cob": "ob"}
+
+
+def parse_callgrind(lines):
+    p = Profile()
+    names = {space: {} for space in set(NAME_SPACES.values())}
+    npositions = 1
+    fn = None
+    cfn = None
+    in_call = False
+
+    def resolve(key, value):
+        # name compression: "(id) name" defines, "(id)" refers
+        m = re.match(r"\((\d+)\)\s*(.*)", value)
+        if not m:
+            return value
+        table = names[NAME_SPACES[key]]
+        if m.group(2):
+            table[m.group(1)] = m.group(2)
+        return table.get(m.group(1), value)
+
+    for line in lines:
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        if line.startswith("positions:"):
+            npositions = len(line.split()[1:])
+        elif line.startswith("fn="):
+            fn = resolve("fn", line[3:])
+        elif line.startswith("cfn="):
+            cfn = resolve("cfn", line[4:])
+        elif line.startswith("calls="):
+            in_call = True
+        elif line[0].isdigit() or line[0] in "+-*":
+            tokens = line.split()
+            cost = float(tokens[npositions]) if len(tokens) > npositions else 0.0
+            if fn is None:
+                continue
+            if in_call:
+                # inclusive cost of the call; recursion would be counted twice
+                if cfn != fn:
+                    p.inclusive[fn] += cost
+                in_call = False
+            else:
+                p.exclusive[fn] += cost
+                p.inclusive[fn] += cost
+                p.stacks[fn] += cost
+                p.total += cost
+        elif "=" in line and line.split("=", 1)[0] in NAME_SPACES:
+            # fl=, fi=, fe=, ob=, cob=, cfi= ... define compressed names too
+            key, value = line.split("=", 1)
+            resolve(key, value)
+    return p
+
+
+def load(path):
+    with open(path, errors="replace") as f:
+        lines = f.readlines()
+    head = "".join(lines[:20])
+    if "events:" in head or "version:" in head or path.split("/")[-1].startswith("callgrind.out"):
+        return parse_callgrind(lines)
+    return parse_folded(lines)
+
+
+# ---------------------------------------------------------------- statistics
+
+def mean(xs):
+    return sum(xs) / len(xs)
+
+
+def var(xs):
+    if len(xs) < 2:
+        return 0.0
+    m = mean(xs)
+    return sum((x - m) ** 2 for x in xs) / (len(xs) - 1)
+
+
+def betacf(a, b, x):
+    # continued fraction of the incomplete beta function (Numerical Recipes)
+    qab, qap, qam = a + b, a + 1, a - 1
+    c, d = 1.0, 1 - qab * x / qap
+    d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+    h = d
+    for m in range(1, 200):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1 + aa * d
+        d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1 + aa / c if abs(c) > 1e-30 else 1e30
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1 + aa * d
+        d = 1 / (d if abs(d) > 1e-30 else 1e-30)
+        c = 1 + aa / c if abs(c) > 1e-30 else 1e30
+        de = d * c
+        h *= de
+        if abs(de - 1) < 1e-12:
+            break
+    return h
+
+
+def betai(a, b, x):
+    if x <= 0:
+        return 0.0
+    if x >= 1:
+        return 1.0
+    lbeta = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+    front = math.exp(lbeta + a * math.log(x) + b * math.log(1 - x))
+    if x < (a + 1) / (a + b + 2):
+        return front * betacf(a, b, x) / a
+    return 1 - front * betacf(b, a, 1 - x) / b
+
+
+def welch_p(xs, ys):
+    """Two-sided p-value of Welch's t-test, None if it cannot be computed."""
+    if len(xs) < 2 or len(ys) < 2:
+        return None
+    vx, vy = var(xs) / len(xs), var(ys) / len(ys)
+    if vx + vy == 0:
+        return 0.0 if mean(xs) != mean(ys) else 1.0
+    t = (mean(ys) - mean(xs)) / math.sqrt(vx + vy)
+    df = (vx + vy) ** 2 / ((vx ** 2) / (len(xs) - 1) + (vy ** 2) / (len(ys) - 1))
+    return betai(df / 2, 0.5, df / (df + t * t))
+
+
+# ---------------------------------------------------------------- diff
+
+def collect(profiles, attr, normalize):
+    """fn -> list of per-run values (0 when the function is absent in a run)."""
+    fns = set()
+    for p in profiles:
+        fns |= set(getattr(p, attr))
+    out = {}
+    for fn in fns:
+        vals = []
+        for p in profiles:
+            v = getattr(p, attr).get(fn, 0.0)
+            vals.append(100.0 * v / p.total if normalize and p.total else v)
+        out[fn] = vals
+    return out
+
+
+def diff(a, b, normalize):
+    rows = []
+    inc_a, inc_b = collect(a, "inclusive", normalize), collect(b, "inclusive", normalize)
+    exc_a, exc_b = collect(a, "exclusive", normalize), collect(b, "exclusive", normalize)
+    for fn in set(inc_a) | set(inc_b):
+        ia = inc_a.get(fn, [0.0] * len(a))
+        ib = inc_b.get(fn, [0.0] * len(b))
+        ea = exc_a.get(fn, [0.0] * len(a))
+        eb = exc_b.get(fn, [0.0] * len(b))
+        rows.append({
+            "fn": fn,
+            "incl_a": mean(ia), "incl_b": mean(ib),
+            "excl_a": mean(ea), "excl_b": mean(eb),
+            "p_incl": welch_p(ia, ib), "p_excl": welch_p(ea, eb),
+        })
+    return rows
+
+
+def fmt_p(p):
+    return "   n/a" if p is None else "%6.3f" % p
+
+
+# ---------------------------------------------------------------- differential flame graph
+
+def flame_svg(a, b, out_path, width=1200, frame_h=16):
+    """Widths follow the new profile (b), color shows the change of the frame's cost:
+    red -- grew, blue -- shrank, intensity -- relative change (as in Brendan Gregg's difffolded)."""
+    sa, sb = defaultdict(float), defaultdict(float)
+    for p in a:
+        for k, v in p.stacks.items():
+            sa[k] += v / len(a)
+    for p in b:
+        for k, v in p.stacks.items():
+            sb[k] += v / len(b)
+
+    def tree(stacks):
+        root = {"children": {}, "value": 0.0, "self": 0.0}
+        for stack, v in stacks.items():
+            node = root
+            node["value"] += v
+            for fr in stack.split(";"):
+                node = node["children"].setdefault(fr, {"children": {}, "value": 0.0, "self": 0.0})
+                node["value"] += v
+            node["self"] += v
+        return root
+
+    ta, tb = tree(sa), tree(sb)
+    total = tb["value"] or 1.0
+    rects = []
+
+    def walk(nb, na, x, depth, path):
+        for name in sorted(nb["children"]):
+            cb = nb["children"][name]
+            ca = na["children"].get(name) if na else None
+            w = cb["value"] / total * width
+            if w >= 0.1:
+                before = ca["value"] if ca else 0.0
+                rects.append((x, depth, w, name, before, cb["value"], path + [name]))
+                walk(cb, ca, x, depth + 1, path + [name])
+            x += w
+
+    walk(tb, ta, 0.0, 0, [])
+    max_depth = max((r[1] for r in rects), default=0) + 1
+    height = (max_depth + 2) * frame_h
+    out = ['<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" font-family="monospace" '
+           'font-size="11">' % (width, height),
+           '<text x="4" y="12">differential flame graph: width = new, red = slower, blue = faster</text>']
+    for x, depth, w, name, before, after, path in rects:
+        y = height - (depth + 1) * frame_h
+        delta = after - before
+        rel = min(1.0, abs(delta) / max(before, after, 1e-9))
+        shade = int(255 * (1 - rel))
+        color = "rgb(255,%d,%d)" % (shade, shade) if delta > 0 else "rgb(%d,%d,255)" % (shade, shade)
+        title = "%s\nbefore %.1f, after %.1f (%+.1f)" % (";".join(path), before, after, delta)
+        title = title.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;")
+        label = name if len(name) * 7 < w else (name[:int(w / 7) - 2] + ".." if w > 30 else "")
+        label = label.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;")
+        out.append('<g><title>%s</title><rect x="%.1f" y="%d" width="%.1f" height="%d" fill="%s" '
+                   'stroke="white" stroke-width="0.5"/><text x="%.1f" y="%d">%s</text></g>'
+                   % (title, x, y, w, frame_h - 1, color, x + 2, y + frame_h - 4, label))
+    out.append("</svg>")
+    with open(out_path, "w") as f:
+        f.write("\n".join(out))
+
+
+# ---------------------------------------------------------------- main
+
+def main():
+    a_files, b_files, side = [], [], None
+    svg, threshold, alpha, normalize, top = None, 5.0, 0.05, False, 30
+    for arg in sys.argv[1:]:
+        if arg == "-a":
+            side = a_files
+        elif arg == "-b":
+            side = b_files
+        elif arg.startswith("--svg="):
+            svg = arg.split("=", 1)[1]
+        elif arg.startswith("--threshold="):
+            threshold = float(arg.split("=", 1)[1])
+        elif arg.startswith("--alpha="):
+            alpha = float(arg.split("=", 1)[1])
+        elif arg.startswith("--top="):
+            top = int(arg.split("=", 1)[1])
+        elif arg == "--normalize":
+            normalize = True
+        elif side is not None:
+            side.append(arg)
+        else:
+            print("unexpected argument %s" % arg, file=sys.stderr)
+            sys.exit(2)
+    if not a_files or not b_files:
+        print("usage: profdiff.py -a <base profiles...> -b <new profiles...> [--svg=diff.svg] "
+              "[--threshold=5] [--alpha=0.05] [--normalize] [--top=30]", file=sys.stderr)
+        sys.exit(2)
+
+    a = [load(f) for f in a_files]
+    b = [load(f) for f in b_files]
+    total_a = mean([p.total for p in a]) if not normalize else 100.0
+    rows = diff(a, b, normalize)
+    rows.sort(key=lambda r: -abs(r["excl_b"] - r["excl_a"]))
+
+    unit = "%" if normalize else ""
+    print("runs: %d vs %d, total: %.1f%s vs %.1f%s" % (len(a), len(b), total_a, unit,
+          mean([p.total for p in b]) if not normalize else 100.0, unit))
+    print("%12s %12s %9s %6s %12s %12s %9s %6s  %s" % ("excl A", "excl B", "delta%", "p", "incl A",
+          "incl B", "delta%", "p", "function"))
+    regressions = []
+    for r in rows[:top] if top else rows:
+        d_exc = 100.0 * (r["excl_b"] - r["excl_a"]) / total_a if total_a else 0.0
+        d_inc = 100.0 * (r["incl_b"] - r["incl_a"]) / total_a if total_a else 0.0
+        print("%12.1f %12.1f %+9.2f %s %12.1f %12.1f %+9.2f %s  %s"
+              % (r["excl_a"], r["excl_b"], d_exc, fmt_p(r["p_excl"]), r["incl_a"], r["incl_b"],
+                 d_inc, fmt_p(r["p_incl"]), r["fn"]))
+    for r in rows:
+        d_exc = 100.0 * (r["excl_b"] - r["excl_a"]) / total_a if total_a else 0.0
+        # with a single run per side there is no p-value, the threshold alone decides
+        if d_exc > threshold and (r["p_excl"] is None or r["p_excl"] < alpha):
+            regressions.append((r["fn"], d_exc))
+    if svg:
+        flame_svg(a, b, svg)
+    if regressions:
+        for fn, d in regressions:
+            print("REGRESSION: %s self cost +%.2f%% of total" % (fn, d), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
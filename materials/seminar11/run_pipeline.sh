@@ -1,13 +1,27 @@
-VISUALIZER=gprof2dot.py     
-if [ ! -f $VISUALIZER ]; then
-    wget https://raw.githubusercontent.com/jrfonseca/gprof2dot/master/gprof2dot.py
-fi
-
+# usage: ./run_pipeline.sh [file.cpp] [sampler|offcpu|callgrind]
+#   sampler   (default) -- in-process sampling profiler, see sampler/readme.md
+#   offcpu    -- sampler plus time blocked in join/locks/sleeps/IO, and a timeline a.out.trace.json
+#   callgrind -- valgrind --tool=callgrind + gprof2dot (downloaded on first use), 20-100x slower
 FN=$1
-if [ ! -f $1 ]; then
+if [ ! -f "$FN" ]; then
     FN=1.cpp
 fi
+MODE=${2:-sampler}
 
-g++ 1.cpp -o a.out
-valgrind --tool=callgrind ./a.out
-python3 gprof2dot.py -n0 -e0 $(find . -name callgrind.out* | tail -n 1) -f callgrind | dot  -Tpng -o $(find . -name callgrind.out* | tail -n 1)_pic.png
+if [ "$MODE" = "callgrind" ]; then
+    VISUALIZER=gprof2dot.py
+    if [ ! -f $VISUALIZER ]; then
+        wget https://raw.githubusercontent.com/jrfonseca/gprof2dot/master/gprof2dot.py
+    fi
+    g++ $FN -o a.out
+    valgrind --tool=callgrind ./a.out
+    python3 gprof2dot.py -n0 -e0 $(find . -name callgrind.out* | tail -n 1) -f callgrind | dot  -Tpng -o $(find . -name callgrind.out* | tail -n 1)_pic.png
+else
+    g++ -O2 -fPIC -shared sampler/sampler.cpp sampler/offcpu.cpp -o libsampler.so -ldl -lpthread
+    g++ $CXXFLAGS -fno-omit-frame-pointer -rdynamic $FN -o a.out -lpthread
+    if [ "$MODE" = "offcpu" ]; then
+        export SAMPLER_OFFCPU=${SAMPLER_OFFCPU:-0} SAMPLER_TIMELINE=a.out.trace.json
+    fi
+    SAMPLER_OUT=a.out.folded SAMPLER_HZ=${SAMPLER_HZ:-1000} LD_PRELOAD=./libsampler.so ./a.out
+    python3 sampler/folded2dot.py a.out.folded --top=10 | dot -Tpng -o a.out.folded_pic.png
+fi
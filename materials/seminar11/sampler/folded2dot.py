@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# Folded stacks ("main;f;g 42" per line) -> DOT call graph, offline replacement of gprof2dot.
+# usage: python3 folded2dot.py prog.folded [--threshold=0.5] [--top=20] | dot -Tpng -o prog.png
+import sys
+from collections import defaultdict
+
+
+def parse(path):
+    stacks = []
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not line:
+                continue
+            frames, count = line.rsplit(" ", 1)
+            stacks.append((frames.split(";"), int(count)))
+    return stacks
+
+
+def aggregate(stacks):
+    inclusive = defaultdict(int)
+    exclusive = defaultdict(int)
+    edges = defaultdict(int)
+    for frames, count in stacks:
+        for fn in set(frames):   # recursion is counted once per stack
+            inclusive[fn] += count
+        exclusive[frames[-1]] += count
+        for caller, callee in set(zip(frames, frames[1:])):
+            edges[(caller, callee)] += count
+    return inclusive, exclusive, edges
+
+
+def color(share):
+    # blue (cold) -> red (hot), like gprof2dot
+    r = int(255 * min(1.0, share * 2))
+    b = int(255 * min(1.0, (1 - share) * 2))
+    return "#%02x40%02x" % (r, b)
+
+
+def to_dot(inclusive, exclusive, edges, total, threshold):
+    keep = {fn for fn, v in inclusive.items() if 100.0 * v / total >= threshold}
+    ids = {fn: "n%d" % i for i, fn in enumerate(sorted(keep))}
+    out = ["digraph callgraph {",
+           '  node [shape=box, style=filled, fontcolor=white, fontname="monospace"];']
+    for fn in sorted(keep):
+        inc = inclusive[fn] / total
+        exc = exclusive[fn] / total
+        label = "%s\\n%.2f%%\\n(%.2f%%)" % (fn.replace('"', '\\"'), 100 * inc, 100 * exc)
+        out.append('  %s [label="%s", fillcolor="%s"];' % (ids[fn], label, color(inc)))
+    for (caller, callee), v in sorted(edges.items()):
+        if caller in keep and callee in keep:
+            share = v / total
+            out.append('  %s -> %s [label="%.2f%%", penwidth=%.1f, color="%s"];'
+                       % (ids[caller], ids[callee], 100 * share, 1 + 4 * share, color(share)))
+    out.append("}")
+    return "\n".join(out)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: folded2dot.py <file.folded> [--threshold=0.5] [--top=N]", file=sys.stderr)
+        sys.exit(1)
+    threshold = 0.5
+    top = 0
+    for arg in sys.argv[2:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg.split("=", 1)[1])
+        elif arg.startswith("--top="):
+            top = int(arg.split("=", 1)[1])
+    stacks = parse(sys.argv[1])
+    total = sum(c for _, c in stacks)
+    if total == 0:
+        print("no samples", file=sys.stderr)
+        sys.exit(1)
+    inclusive, exclusive, edges = aggregate(stacks)
+    if top:
+        # flat profile to stderr, the graph still goes to stdout
+        print("%8s %8s  %s" % ("incl%", "self%", "function"), file=sys.stderr)
+        for fn in sorted(inclusive, key=lambda f: -exclusive[f])[:top]:
+            print("%8.2f %8.2f  %s" % (100.0 * inclusive[fn] / total, 100.0 * exclusive[fn] / total, fn),
+                  file=sys.stderr)
+    print(to_dot(inclusive, exclusive, edges, total, threshold))
+
+
+if __name__ == "__main__":
+    main()
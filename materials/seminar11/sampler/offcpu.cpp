@@ -0,0 +1,250 @@
+// Off-CPU part of the sampler: wrappers of blocking calls, see sampler.h (sampler_enable_offcpu).
+//
+// Every wrapper forwards to the real function (dlsym(RTLD_NEXT)) and, when off-CPU mode is active
+// for the calling thread, measures wall time and thread CPU time around the call. Their difference
+// is the time the thread was not running; if it is at least the threshold, the stack of the caller
+// (glibc backtrace, DWARF based: works without frame pointers) is recorded in sampler.cpp.
+// Wall minus CPU time keeps the in-kernel part of read/write or a spinning mutex from being
+// counted twice: the CPU-time timers already sample it.
+//
+// Only calls through the dynamic symbol table are seen: locks inside glibc (stdio FILE locks
+// of printf/cout) use futexes directly and stay invisible, as does code built with -static.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sampler_internal.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace sampler_internal;
+
+__thread bool tls_inside __attribute__((tls_model("initial-exec")));
+
+uint64_t thread_cpu_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Lookup of the next definition. pthread_cond_* have two versions in glibc on x86-64,
+// plain dlsym returns the old one (GLIBC_2.2.5) which is incompatible with new condition variables.
+void* real(const char* name, const char* version = nullptr) {
+    void* fn = version ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+    return fn ? fn : dlsym(RTLD_NEXT, name);
+}
+
+// static auto real_<name> = pointer to the next <name>
+#define REAL(ret, name, params, ...) \
+    static auto real_##name = (ret(*) params)real(#name, ##__VA_ARGS__)
+
+// Times one blocking call of the current thread. Inactive (and free) when the mode is off,
+// for unregistered threads and for calls made by the profiler itself.
+class Blocked {
+public:
+    explicit Blocked(const char* what) : what_(what), active_(!tls_inside && offcpu_active()) {
+        if (!active_)
+            return;
+        tls_inside = true;
+        wall_ = monotonic_ns();
+        cpu_ = thread_cpu_ns();
+    }
+
+    __attribute__((noinline)) ~Blocked() {
+        if (!active_)
+            return;
+        int saved_errno = errno;
+        uint64_t end = monotonic_ns();
+        uint64_t wall = end - wall_;
+        uint64_t cpu = thread_cpu_ns() - cpu_;
+        uint64_t blocked = wall > cpu ? wall - cpu : 0;
+        if (blocked > 0 && (int64_t)blocked >= offcpu_min_ns()) {
+            void* frames[MAX_DEPTH + 2];
+            int n = backtrace(frames, MAX_DEPTH + 2);
+            // frames[0] is this destructor, frames[1] the wrapper
+            uintptr_t pcs[MAX_DEPTH];
+            int depth = 0;
+            for (int i = 2; i < n; i++)
+                pcs[depth++] = (uintptr_t)frames[i] - 1;
+            record_offcpu(what_, wall_, end, blocked, pcs, depth);
+        }
+        tls_inside = false;
+        errno = saved_errno;
+    }
+
+    Blocked(const Blocked&) = delete;
+    Blocked& operator=(const Blocked&) = delete;
+
+private:
+    const char* what_;
+    bool active_;
+    uint64_t wall_ = 0, cpu_ = 0;
+};
+
+// The first backtrace() loads libgcc_s; do it before any wrapper needs it.
+__attribute__((constructor)) void preload_unwinder() {
+    void* frame;
+    backtrace(&frame, 1);
+}
+
+} // namespace
+
+extern "C" {
+
+int pthread_join(pthread_t thread, void** ret) {
+    REAL(int, pthread_join, (pthread_t, void**));
+    Blocked b("pthread_join");
+    return real_pthread_join(thread, ret);
+}
+
+// Uncontended locks are not interesting and should stay cheap: try first, time only the wait.
+int pthread_mutex_lock(pthread_mutex_t* m) {
+    REAL(int, pthread_mutex_lock, (pthread_mutex_t*));
+    REAL(int, pthread_mutex_trylock, (pthread_mutex_t*));
+    if (tls_inside || !offcpu_active())
+        return real_pthread_mutex_lock(m);
+    int rc = real_pthread_mutex_trylock(m);
+    if (rc != EBUSY)
+        return rc;
+    Blocked b("pthread_mutex_lock");
+    return real_pthread_mutex_lock(m);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* l) {
+    REAL(int, pthread_rwlock_rdlock, (pthread_rwlock_t*));
+    Blocked b("pthread_rwlock_rdlock");
+    return real_pthread_rwlock_rdlock(l);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* l) {
+    REAL(int, pthread_rwlock_wrlock, (pthread_rwlock_t*));
+    Blocked b("pthread_rwlock_wrlock");
+    return real_pthread_rwlock_wrlock(l);
+}
+
+int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m) {
+    REAL(int, pthread_cond_wait, (pthread_cond_t*, pthread_mutex_t*), "GLIBC_2.3.2");
+    Blocked b("pthread_cond_wait");
+    return real_pthread_cond_wait(c, m);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t) {
+    REAL(int, pthread_cond_timedwait, (pthread_cond_t*, pthread_mutex_t*, const struct timespec*), "GLIBC_2.3.2");
+    Blocked b("pthread_cond_timedwait");
+    return real_pthread_cond_timedwait(c, m, t);
+}
+
+#if __GLIBC_PREREQ(2, 30)
+// std::condition_variable::wait_for/wait_until in libstdc++ built against glibc >= 2.30
+int pthread_cond_clockwait(pthread_cond_t* c, pthread_mutex_t* m, clockid_t clock, const struct timespec* t) {
+    REAL(int, pthread_cond_clockwait, (pthread_cond_t*, pthread_mutex_t*, clockid_t, const struct timespec*));
+    Blocked b("pthread_cond_clockwait");
+    return real_pthread_cond_clockwait(c, m, clock, t);
+}
+#endif
+
+int sem_wait(sem_t* s) {
+    REAL(int, sem_wait, (sem_t*));
+    Blocked b("sem_wait");
+    return real_sem_wait(s);
+}
+
+int nanosleep(const struct timespec* req, struct timespec* rem) {
+    REAL(int, nanosleep, (const struct timespec*, struct timespec*));
+    Blocked b("nanosleep");
+    return real_nanosleep(req, rem);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* req, struct timespec* rem) {
+    REAL(int, clock_nanosleep, (clockid_t, int, const struct timespec*, struct timespec*));
+    Blocked b("clock_nanosleep");
+    return real_clock_nanosleep(clock, flags, req, rem);
+}
+
+// glibc implements these with an internal call of nanosleep, which is not interposed
+int usleep(useconds_t us) {
+    REAL(int, usleep, (useconds_t));
+    Blocked b("usleep");
+    return real_usleep(us);
+}
+
+unsigned sleep(unsigned s) {
+    REAL(unsigned, sleep, (unsigned));
+    Blocked b("sleep");
+    return real_sleep(s);
+}
+
+ssize_t read(int fd, void* buf, size_t n) {
+    REAL(ssize_t, read, (int, void*, size_t));
+    Blocked b("read");
+    return real_read(fd, buf, n);
+}
+
+ssize_t write(int fd, const void* buf, size_t n) {
+    REAL(ssize_t, write, (int, const void*, size_t));
+    Blocked b("write");
+    return real_write(fd, buf, n);
+}
+
+int poll(struct pollfd* fds, nfds_t n, int timeout) {
+    REAL(int, poll, (struct pollfd*, nfds_t, int));
+    Blocked b("poll");
+    return real_poll(fds, n, timeout);
+}
+
+int select(int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* t) {
+    REAL(int, select, (int, fd_set*, fd_set*, fd_set*, struct timeval*));
+    Blocked b("select");
+    return real_select(n, r, w, e, t);
+}
+
+int epoll_wait(int fd, struct epoll_event* events, int n, int timeout) {
+    REAL(int, epoll_wait, (int, struct epoll_event*, int, int));
+    Blocked b("epoll_wait");
+    return real_epoll_wait(fd, events, n, timeout);
+}
+
+int accept(int fd, struct sockaddr* addr, socklen_t* len) {
+    REAL(int, accept, (int, struct sockaddr*, socklen_t*));
+    Blocked b("accept");
+    return real_accept(fd, addr, len);
+}
+
+// libstdc++ waits on futexes through syscall(): std::atomic::wait, std::latch, std::barrier,
+// std::counting_semaphore (C++20). Other system calls pass through untouched.
+long syscall(long number, ...) {
+    REAL(long, syscall, (long, ...));
+    // the kernel takes at most 6 arguments; reading unused ones is harmless in the x86-64/AArch64 ABIs
+    va_list ap;
+    va_start(ap, number);
+    long a[6];
+    for (long& x : a)
+        x = va_arg(ap, long);
+    va_end(ap);
+    int op = (int)a[1] & FUTEX_CMD_MASK;
+    if (number == SYS_futex && (op == FUTEX_WAIT || op == FUTEX_WAIT_BITSET)) {
+        Blocked b("futex");
+        return real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+    return real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+} // extern "C"
@@ -0,0 +1,591 @@
+// In-process sampling profiler, see sampler.h and readme.md.
+//
+// Every registered thread gets a timer on its own CPU-time clock (timer_create + SIGEV_THREAD_ID),
+// so a thread is sampled only while it runs. The SIGPROF handler walks frame pointers and pushes
+// the stack into the thread's single-producer/single-consumer ring. A collector thread drains the
+// rings and aggregates identical stacks; symbolization (dladdr) happens only once, at stop.
+// Off-CPU mode (offcpu.cpp) adds the time threads spend blocked, timeline mode keeps every
+// sample and every blocked interval with its timestamp for a Chrome trace.
+//
+// build (library):  g++ -O2 -fPIC -shared sampler.cpp offcpu.cpp -o libsampler.so -ldl -lpthread
+//                   (add -DSAMPLER_USE_LIBUNWIND ... -lunwind to unwind without frame pointers)
+// profile:          g++ -O2 -fno-omit-frame-pointer -rdynamic prog.cpp -o prog
+//                   SAMPLER_OUT=prog.folded SAMPLER_HZ=1000 LD_PRELOAD=./libsampler.so ./prog
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sampler.h"
+#include "sampler_internal.h"
+#include "symbolize.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#ifdef SAMPLER_USE_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#endif
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+
+const int MAX_THREADS = 512;
+using sampler_internal::MAX_DEPTH;
+const uint64_t RING_WORDS = 1 << 18;   // 2 MiB per thread, pages are touched only when used
+const int COLLECT_PERIOD_MS = 20;
+const size_t MAX_SPANS = 1 << 22;      // per kind, ~100 MiB at most
+
+enum SlotState { FREE, ACTIVE, RETIRED };
+
+struct ThreadBuf {
+    std::atomic<uint64_t> head;      // written by the signal handler only
+    std::atomic<uint64_t> tail;      // written by the collector only
+    std::atomic<uint64_t> dropped;
+    std::atomic<int> state;
+    pid_t tid;
+    clockid_t clock;
+    uintptr_t stack_lo, stack_hi;
+    timer_t timer;
+    bool armed;
+    uint64_t words[RING_WORDS];      // records: depth | periods << 32, timestamp ns, pc[depth] (leaf first)
+};
+
+ThreadBuf* g_slots[MAX_THREADS];
+std::mutex g_mutex;                  // registration, timers, slot recycling
+std::atomic<bool> g_running{false};
+int g_hz = 0;
+pthread_t g_collector;
+bool g_collector_stop = false;       // under g_collector_mutex
+std::mutex g_collector_mutex;
+std::condition_variable g_collector_cv;
+typedef std::map<std::vector<uintptr_t>, uint64_t> StackCounts;
+// Owned by the collector while running. Never destroyed: sampler_stop may run from atexit
+// after static destructors of this library.
+StackCounts* g_stacks = nullptr;
+uint64_t g_dropped = 0;
+
+// Off-CPU stacks: (blocking call, stack) -> blocked ns. Filled by any thread under g_offcpu_lock,
+// a spinlock: the blocking-call wrappers must not use pthread mutexes themselves.
+typedef std::map<std::pair<const char*, std::vector<uintptr_t>>, uint64_t> OffCpuStacks;
+OffCpuStacks* g_offcpu = nullptr;
+std::atomic_flag g_offcpu_lock = ATOMIC_FLAG_INIT;
+int64_t g_offcpu_min_ns = -1;        // < 0: off-CPU mode disabled
+
+// Timeline: one span per sample (what == nullptr) or blocked interval. Stacks point to keys of
+// g_stacks / g_offcpu, map keys never move.
+struct Span {
+    pid_t tid;
+    uint64_t start_ns, end_ns;
+    const std::vector<uintptr_t>* stack;
+    const char* what;
+};
+const char* g_timeline_path = nullptr;
+std::vector<Span>* g_cpu_spans = nullptr;      // collector only
+std::vector<Span>* g_offcpu_spans = nullptr;   // under g_offcpu_lock
+uint64_t g_spans_dropped = 0;
+
+__thread ThreadBuf* tls_buf __attribute__((tls_model("initial-exec")));
+
+typedef int (*pthread_create_fn)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+
+pthread_create_fn real_pthread_create() {
+    static pthread_create_fn fn = (pthread_create_fn)dlsym(RTLD_NEXT, "pthread_create");
+    return fn;
+}
+
+#ifdef SAMPLER_USE_LIBUNWIND
+// DWARF unwinding: works without frame pointers, several times slower per sample.
+int capture_stack(ucontext_t* uc, ThreadBuf*, uintptr_t* pcs) {
+    unw_cursor_t cursor;
+    if (unw_init_local2(&cursor, (unw_context_t*)uc, UNW_INIT_SIGNAL_FRAME) < 0)
+        return 0;
+    int n = 0;
+    do {
+        unw_word_t ip;
+        if (unw_get_reg(&cursor, UNW_REG_IP, &ip) < 0 || ip == 0)
+            break;
+        pcs[n] = n == 0 ? ip : ip - 1;
+        n++;
+    } while (n < MAX_DEPTH && unw_step(&cursor) > 0);
+    return n;
+}
+#else
+// Frame pointer walk, the program must be built with -fno-omit-frame-pointer.
+// A leaf function that does not set up its frame hides its direct caller.
+int capture_stack(ucontext_t* uc, ThreadBuf* b, uintptr_t* pcs) {
+    int n = 0;
+#if defined(__x86_64__)
+    uintptr_t pc = uc->uc_mcontext.gregs[REG_RIP];
+    uintptr_t fp = uc->uc_mcontext.gregs[REG_RBP];
+    uintptr_t sp = uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+    uintptr_t pc = uc->uc_mcontext.pc;
+    uintptr_t fp = uc->uc_mcontext.regs[29];
+    uintptr_t sp = uc->uc_mcontext.sp;
+#else
+    uintptr_t pc = 0, fp = 0, sp = 0;
+#endif
+    pcs[n++] = pc;
+    // frame layout with frame pointers: [fp] = caller's fp, [fp + 8] = return address. Code without frame pointers
+    // leaves any value in the register (fp + 16 may wrap around); the frames of the callers are above the
+    // interrupted stack pointer, and the main thread's stack below it may not be mapped yet
+    uintptr_t lo = std::max(b->stack_lo, sp);
+    while (n < MAX_DEPTH && fp >= lo && fp < b->stack_hi && b->stack_hi - fp >= 2 * sizeof(uintptr_t) &&
+           (fp & (sizeof(uintptr_t) - 1)) == 0) {
+        uintptr_t next = ((uintptr_t*)fp)[0];
+        uintptr_t ret = ((uintptr_t*)fp)[1];
+        if (ret == 0)
+            break;
+        pcs[n++] = ret - 1;   // point into the call instruction, not after it
+        if (next <= fp)
+            break;
+        fp = next;
+    }
+    return n;
+}
+#endif
+
+void on_sigprof(int, siginfo_t* info, void* ucontext) {
+    int saved_errno = errno;
+    ThreadBuf* b = tls_buf;
+    if (!b || !g_running.load(std::memory_order_relaxed)) {
+        errno = saved_errno;
+        return;
+    }
+    uintptr_t pcs[MAX_DEPTH];
+    int n = capture_stack((ucontext_t*)ucontext, b, pcs);
+
+    uint64_t head = b->head.load(std::memory_order_relaxed);
+    uint64_t tail = b->tail.load(std::memory_order_acquire);
+    if (head - tail + n + 2 > RING_WORDS) {
+        b->dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // CPU-time timers expire on scheduler ticks: with HZ=250 a 1 kHz timer fires every 4 ms
+        // and reports the missed periods as overruns, the sample stands for all of them
+        uint64_t periods = 1 + (info->si_overrun > 0 ? info->si_overrun : 0);
+        b->words[head % RING_WORDS] = (uint64_t)n | periods << 32;
+        b->words[(head + 1) % RING_WORDS] = sampler_internal::monotonic_ns();
+        for (int i = 0; i < n; i++)
+            b->words[(head + 2 + i) % RING_WORDS] = pcs[i];
+        b->head.store(head + n + 2, std::memory_order_release);
+    }
+    errno = saved_errno;
+}
+
+bool arm_timer(ThreadBuf* b) {
+    if (b->armed || g_hz <= 0)
+        return b->armed;
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = b->tid;
+    if (timer_create(b->clock, &sev, &b->timer) != 0)
+        return false;
+    struct itimerspec its;
+    its.it_interval.tv_sec = 1 / g_hz;
+    its.it_interval.tv_nsec = (1000000000L / g_hz) % 1000000000L;   // < 1 s: 1 Hz is {1, 0}
+    its.it_value = its.it_interval;
+    if (timer_settime(b->timer, 0, &its, nullptr) != 0) {
+        timer_delete(b->timer);
+        return false;
+    }
+    b->armed = true;
+    return true;
+}
+
+void disarm_timer(ThreadBuf* b) {
+    if (b->armed) {
+        timer_delete(b->timer);
+        b->armed = false;
+    }
+}
+
+// Moves all complete records of one ring into g_stacks. Collector thread (or stop) only.
+void drain(ThreadBuf* b) {
+    uint64_t tail = b->tail.load(std::memory_order_relaxed);
+    uint64_t head = b->head.load(std::memory_order_acquire);
+    std::vector<uintptr_t> stack;
+    uint64_t period_ns = 1000000000ULL / g_hz;
+    while (tail < head) {
+        uint64_t n = b->words[tail % RING_WORDS] & 0xffffffff;
+        uint64_t periods = b->words[tail % RING_WORDS] >> 32;
+        uint64_t ts = b->words[(tail + 1) % RING_WORDS];
+        stack.resize(n);
+        for (uint64_t i = 0; i < n; i++)
+            stack[i] = b->words[(tail + 2 + i) % RING_WORDS];
+        auto it = g_stacks->emplace(stack, 0).first;
+        it->second += periods;
+        if (g_cpu_spans) {
+            // the timer fires at the end of the CPU time it measured
+            if (g_cpu_spans->size() < MAX_SPANS)
+                g_cpu_spans->push_back(Span{b->tid, ts - periods * period_ns, ts, &it->first, nullptr});
+            else
+                g_spans_dropped++;
+        }
+        tail += n + 2;
+    }
+    b->tail.store(tail, std::memory_order_release);
+}
+
+void drain_all() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (int i = 0; i < MAX_THREADS; i++) {
+        ThreadBuf* b = g_slots[i];
+        if (!b || b->state.load() == FREE)
+            continue;
+        drain(b);
+        if (b->state.load() == RETIRED) {
+            g_dropped += b->dropped.exchange(0);
+            b->state.store(FREE);
+        }
+    }
+}
+
+void* collector_main(void*) {
+    std::unique_lock<std::mutex> lock(g_collector_mutex);
+    while (!g_collector_stop) {
+        g_collector_cv.wait_for(lock, std::chrono::milliseconds(COLLECT_PERIOD_MS));
+        drain_all();
+    }
+    return nullptr;
+}
+
+void stop_collector() {
+    {
+        std::lock_guard<std::mutex> lock(g_collector_mutex);
+        g_collector_stop = true;
+    }
+    g_collector_cv.notify_one();
+    pthread_join(g_collector, nullptr);
+}
+
+// Symbolized stack, root first: "main;f;g".
+std::string fold(const std::vector<uintptr_t>& stack, std::unordered_map<uintptr_t, std::string>& names) {
+    std::string line;
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+        auto found = names.find(*it);
+        if (found == names.end())
+            found = names.emplace(*it, symbols::symbolize(*it)).first;
+        if (!line.empty())
+            line += ';';
+        line += found->second;
+    }
+    return line;
+}
+
+std::string offcpu_frame(const char* what) {
+    return std::string("[off-cpu] ") + what;
+}
+
+// Sample counts; in off-CPU mode microseconds of wall time, on-CPU samples converted with the period
+// and blocked stacks ending with an "[off-cpu] <call>" frame.
+void write_folded(const char* path, std::unordered_map<uintptr_t, std::string>& names) {
+    std::map<std::string, uint64_t> folded;   // different pcs of one function collapse here
+    bool wall = g_offcpu_min_ns >= 0;
+    for (auto& s : *g_stacks)
+        folded[fold(s.first, names)] += wall ? s.second * 1000000ULL / g_hz : s.second;
+    if (wall) {
+        for (auto& s : *g_offcpu) {
+            std::string line = fold(s.first.second, names);
+            folded[(line.empty() ? "" : line + ";") + offcpu_frame(s.first.first)] += s.second / 1000;
+        }
+    }
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return;
+    }
+    for (auto& f : folded)
+        if (f.second)
+            fprintf(out, "%s %llu\n", f.first.c_str(), (unsigned long long)f.second);
+    fclose(out);
+    if (g_dropped)
+        fprintf(stderr, "sampler: %llu samples dropped (ring full)\n", (unsigned long long)g_dropped);
+}
+
+// Chrome trace format (chrome://tracing, ui.perfetto.dev): a track per thread, on-CPU samples
+// and blocked intervals as complete ("X") events, the folded stack in args.
+void write_timeline(const char* path, std::unordered_map<uintptr_t, std::string>& names) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return;
+    }
+    std::vector<Span> spans(*g_cpu_spans);
+    spans.insert(spans.end(), g_offcpu_spans->begin(), g_offcpu_spans->end());
+    uint64_t t0 = UINT64_MAX;
+    for (auto& s : spans)
+        t0 = std::min(t0, s.start_ns);
+    std::unordered_map<const std::vector<uintptr_t>*, std::string> folded;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (size_t i = 0; i < spans.size(); i++) {
+        const Span& s = spans[i];
+        auto f = folded.find(s.stack);
+        if (f == folded.end())
+            f = folded.emplace(s.stack, fold(*s.stack, names)).first;
+        std::string stack;
+        for (char c : f->second)   // JSON escaping; symbol names have no control characters
+            stack += (c == '"' || c == '\\') ? std::string("\\") + c : std::string(1, c);
+        std::string name = s.what ? offcpu_frame(s.what) : stack.substr(stack.rfind(';') + 1);
+        fprintf(out, "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                     "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"stack\": \"%s\"}}",
+                i ? ",\n" : "", name.c_str(), s.what ? "off-cpu" : "cpu", (int)s.tid,
+                (s.start_ns - t0) / 1000.0, (s.end_ns - s.start_ns) / 1000.0, stack.c_str());
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    if (g_spans_dropped)
+        fprintf(stderr, "sampler: %llu timeline spans dropped\n", (unsigned long long)g_spans_dropped);
+}
+
+struct StartArgs {
+    void* (*fn)(void*);
+    void* arg;
+};
+
+void unregister_cleanup(void*) {
+    sampler_unregister_thread();
+}
+
+void* thread_trampoline(void* p) {
+    StartArgs args = *(StartArgs*)p;
+    delete (StartArgs*)p;
+    sampler_register_thread();
+    void* ret;
+    pthread_cleanup_push(unregister_cleanup, nullptr);   // also runs on pthread_exit
+    ret = args.fn(args.arg);
+    pthread_cleanup_pop(1);
+    return ret;
+}
+
+const char* g_auto_out = nullptr;
+
+void auto_stop() {
+    sampler_stop(g_auto_out);
+}
+
+__attribute__((constructor)) void auto_start() {
+    g_auto_out = getenv("SAMPLER_OUT");
+    if (!g_auto_out)
+        return;
+    const char* hz = getenv("SAMPLER_HZ");
+    if (const char* offcpu = getenv("SAMPLER_OFFCPU"))
+        sampler_enable_offcpu(atoi(offcpu));
+    sampler_enable_timeline(getenv("SAMPLER_TIMELINE"));
+    int rate = hz ? atoi(hz) : 1000;
+    if (sampler_start(rate) == 0)
+        atexit(auto_stop);
+    else
+        fprintf(stderr, "sampler: could not start at SAMPLER_HZ=%d, no profile will be written to %s\n", rate,
+                g_auto_out);
+}
+
+} // namespace
+
+namespace sampler_internal {
+
+bool offcpu_active() {
+    // unregistered threads (the collector) are not profiled
+    return g_offcpu_min_ns >= 0 && tls_buf && g_running.load(std::memory_order_relaxed);
+}
+
+int64_t offcpu_min_ns() {
+    return g_offcpu_min_ns;
+}
+
+void record_offcpu(const char* what, uint64_t start_ns, uint64_t end_ns, uint64_t blocked_ns,
+                   const uintptr_t* pcs, int n) {
+    ThreadBuf* b = tls_buf;
+    if (!b)
+        return;
+    while (g_offcpu_lock.test_and_set(std::memory_order_acquire))
+        ;
+    if (g_running.load()) {
+        auto it = g_offcpu->emplace(std::make_pair(what, std::vector<uintptr_t>(pcs, pcs + n)), 0).first;
+        it->second += blocked_ns;
+        if (g_offcpu_spans) {
+            if (g_offcpu_spans->size() < MAX_SPANS)
+                g_offcpu_spans->push_back(Span{b->tid, start_ns, end_ns, &it->first.second, what});
+            else
+                g_spans_dropped++;
+        }
+    }
+    g_offcpu_lock.clear(std::memory_order_release);
+}
+
+} // namespace sampler_internal
+
+extern "C" {
+
+void sampler_register_thread(void) {
+    if (tls_buf)
+        return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ThreadBuf* b = nullptr;
+    for (int i = 0; i < MAX_THREADS && !b; i++) {
+        if (!g_slots[i]) {
+            void* mem = mmap(nullptr, sizeof(ThreadBuf), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED)
+                return;
+            g_slots[i] = (ThreadBuf*)mem;   // zero-filled: FREE, empty ring
+        }
+        if (g_slots[i]->state.load() == FREE)
+            b = g_slots[i];
+    }
+    if (!b)
+        return;   // too many threads, this one is not sampled
+    b->head.store(0);
+    b->tail.store(0);
+    b->tid = (pid_t)syscall(SYS_gettid);
+    pthread_getcpuclockid(pthread_self(), &b->clock);
+    pthread_attr_t attr;
+    void* stack_addr = nullptr;
+    size_t stack_size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+        pthread_attr_destroy(&attr);
+    }
+    b->stack_lo = (uintptr_t)stack_addr;
+    b->stack_hi = (uintptr_t)stack_addr + stack_size;
+    b->state.store(ACTIVE);
+    tls_buf = b;
+    if (g_running.load())
+        arm_timer(b);
+}
+
+void sampler_unregister_thread(void) {
+    ThreadBuf* b = tls_buf;
+    if (!b)
+        return;
+    tls_buf = nullptr;   // a pending SIGPROF now sees no buffer
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    disarm_timer(b);
+    b->state.store(RETIRED);   // the collector frees the slot once drained
+}
+
+int sampler_start(int hz) {
+    if (hz <= 0 || g_running.load())
+        return -1;
+    struct sigaction sa, old_sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_sigprof;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, &old_sa) != 0)
+        return -1;
+
+    sampler_register_thread();
+    if (!g_stacks)
+        g_stacks = new StackCounts;
+    g_stacks->clear();
+    g_dropped = 0;
+    if (!g_offcpu)
+        g_offcpu = new OffCpuStacks;
+    g_offcpu->clear();
+    delete g_cpu_spans;
+    delete g_offcpu_spans;
+    g_cpu_spans = g_timeline_path ? new std::vector<Span> : nullptr;
+    g_offcpu_spans = g_timeline_path ? new std::vector<Span> : nullptr;
+    g_spans_dropped = 0;
+    g_collector_stop = false;
+    g_hz = hz;   // before the collector: drain divides by it
+    if (real_pthread_create()(&g_collector, nullptr, collector_main, nullptr) != 0) {
+        sigaction(SIGPROF, &old_sa, nullptr);
+        return -1;
+    }
+
+    int armed = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_running.store(true);
+        for (int i = 0; i < MAX_THREADS; i++)
+            if (g_slots[i] && g_slots[i]->state.load() == ACTIVE)
+                armed += arm_timer(g_slots[i]);
+    }
+    if (!armed) {
+        // no timer, no samples: not started, so that a later sampler_start can try again
+        g_running.store(false);
+        stop_collector();   // after releasing g_mutex: the collector takes it to drain
+        sigaction(SIGPROF, &old_sa, nullptr);
+        return -1;
+    }
+    return 0;
+}
+
+void sampler_stop(const char* folded_path) {
+    if (!g_running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (int i = 0; i < MAX_THREADS; i++)
+            if (g_slots[i])
+                disarm_timer(g_slots[i]);
+    }
+    stop_collector();
+    drain_all();
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (int i = 0; i < MAX_THREADS; i++)
+            if (g_slots[i])
+                g_dropped += g_slots[i]->dropped.exchange(0);
+    }
+    // wrappers still inside record_offcpu finish first, later ones see g_running == false
+    while (g_offcpu_lock.test_and_set(std::memory_order_acquire))
+        ;
+    g_offcpu_lock.clear(std::memory_order_release);
+    std::unordered_map<uintptr_t, std::string> names;
+    if (folded_path)
+        write_folded(folded_path, names);
+    if (g_timeline_path)
+        write_timeline(g_timeline_path, names);
+}
+
+void sampler_enable_offcpu(int min_us) {
+    if (!g_running.load())
+        g_offcpu_min_ns = min_us < 0 ? -1 : (int64_t)min_us * 1000;
+}
+
+void sampler_enable_timeline(const char* path) {
+    if (!g_running.load())
+        g_timeline_path = path;
+}
+
+// Interposed so that threads are registered (and sampled) without changes in the program.
+int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*fn)(void*), void* arg) {
+    StartArgs* args = new StartArgs{fn, arg};
+    int rc = real_pthread_create()(thread, attr, thread_trampoline, args);
+    if (rc != 0)
+        delete args;
+    return rc;
+}
+
+} // extern "C"
@@ -0,0 +1,52 @@
+// In-process sampling profiler: SIGPROF from per-thread CPU-time timers,
+// frame pointer stack walk, folded stacks at exit. See readme.md.
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Starts sampling of every registered thread (the calling one is registered
+ * automatically) with the given frequency in Hz.
+ * @return 0 on success, -1 if timers could not be created (nothing is left running then).
+ */
+int sampler_start(int hz);
+
+/**
+ * Stops sampling, symbolizes collected stacks and writes them in folded
+ * format ("main;f;g 42" per line) to folded_path.
+ */
+void sampler_stop(const char* folded_path);
+
+/**
+ * Off-CPU mode: blocking calls (pthread_join, mutex and condition variable waits,
+ * sleeps, read/write, poll, futex waits) are intercepted and the time the thread
+ * spent blocked in them is attributed to the calling stack, see offcpu.cpp.
+ * The folded output is then in microseconds of wall time: on-CPU samples are
+ * converted with the sampling period, blocked stacks end with "[off-cpu] <call>".
+ * Calls blocked for less than min_us are ignored, min_us < 0 disables the mode.
+ * Must be called before sampler_start.
+ */
+void sampler_enable_offcpu(int min_us);
+
+/**
+ * Keeps every sample and blocked interval with its timestamp; sampler_stop writes
+ * them to path as a Chrome trace (chrome://tracing, ui.perfetto.dev), a track per
+ * thread. NULL disables. Must be called before sampler_start.
+ */
+void sampler_enable_timeline(const char* path);
+
+/**
+ * Threads created with pthread_create are registered automatically,
+ * these are for threads created some other way.
+ */
+void sampler_register_thread(void);
+void sampler_unregister_thread(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLER_H
@@ -0,0 +1,29 @@
+// Interface between sampler.cpp and offcpu.cpp, not for programs.
+#ifndef SAMPLER_INTERNAL_H
+#define SAMPLER_INTERNAL_H
+
+#include <cstdint>
+#include <time.h>
+
+namespace sampler_internal {
+
+const int MAX_DEPTH = 64;
+
+// CLOCK_MONOTONIC, async-signal-safe (vDSO); the time base of timeline spans.
+inline uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// The calling thread is registered, sampling runs and off-CPU mode is on.
+bool offcpu_active();
+int64_t offcpu_min_ns();
+
+// Blocked time of one intercepted call; pcs are return addresses (minus one), leaf first.
+void record_offcpu(const char* what, uint64_t start_ns, uint64_t end_ns, uint64_t blocked_ns,
+                   const uintptr_t* pcs, int n);
+
+} // namespace sampler_internal
+
+#endif // SAMPLER_INTERNAL_H
@@ -0,0 +1,40 @@
+// Names of code addresses for the reports of sampler.cpp, ../heapprof and ../tracer, not for programs.
+#ifndef SYMBOLIZE_H
+#define SYMBOLIZE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+namespace symbols {
+
+// The demangled symbol of pc; "lib.so+0x1234" without one (static functions, no -rdynamic), else "0x...".
+inline std::string symbolize(uintptr_t pc) {
+    Dl_info info;
+    char buf[64];
+    if (!dladdr((void*)pc, &info))
+        info.dli_fname = nullptr;
+    else if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : info.dli_sname;
+        free(demangled);
+        return name;
+    }
+    if (info.dli_fname) {
+        const char* base = strrchr(info.dli_fname, '/');
+        snprintf(buf, sizeof(buf), "+0x%lx", (unsigned long)(pc - (uintptr_t)info.dli_fbase));
+        return std::string(base ? base + 1 : info.dli_fname) + buf;
+    }
+    snprintf(buf, sizeof(buf), "0x%lx", (unsigned long)pc);
+    return buf;
+}
+
+} // namespace symbols
+
+#endif // SYMBOLIZE_H
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# Converter of tracer.cpp binary traces.
+# usage: python3 trace_convert.py prog.trace summary
+#        python3 trace_convert.py prog.trace chrome out.json      (chrome://tracing, ui.perfetto.dev)
+#        python3 trace_convert.py prog.trace callgrind callgrind.out.prog   (kcachegrind, gprof2dot)
+import json
+import struct
+import sys
+from collections import defaultdict
+
+TAG_CHUNK = 1
+TAG_SYMBOLS = 2
+EXIT_BIT = 1 << 63
+
+
+def read_trace(path):
+    """Returns (ticks_per_second, overhead_ticks, {tid: [(ticks, fn, is_exit)]}, {fn: name})."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"FTRC":
+        raise ValueError("%s: not a tracer file" % path)
+    version, tps, overhead = struct.unpack_from("<Idd", data, 4)
+    pos = 4 + 4 + 16
+    threads = defaultdict(list)
+    names = {}
+    while pos + 4 <= len(data):
+        (tag,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        if tag == TAG_CHUNK:
+            tid, count = struct.unpack_from("<II", data, pos)
+            pos += 8
+            for ticks, fn in struct.iter_unpack("<QQ", data[pos:pos + 16 * count]):
+                threads[tid].append((ticks, fn & ~EXIT_BIT, bool(fn & EXIT_BIT)))
+            pos += 16 * count
+        elif tag == TAG_SYMBOLS:
+            (count,) = struct.unpack_from("<I", data, pos)
+            pos += 4
+            for _ in range(count):
+                fn, length = struct.unpack_from("<QI", data, pos)
+                pos += 12
+                names[fn] = data[pos:pos + length].decode(errors="replace")
+                pos += length
+        else:
+            break
+    return tps, overhead, threads, names
+
+
+def name_of(names, fn):
+    return names.get(fn, "0x%x" % fn)
+
+
+def calls(events):
+    """Matches enter/exit pairs. Yields (fn, caller_fn or None, start, end, child_ticks)."""
+    stack = []   # [fn, start, child_ticks]
+    last = events[-1][0] if events else 0
+    for ticks, fn, is_exit in events:
+        if not is_exit:
+            stack.append([fn, ticks, 0])
+            continue
+        # unmatched exits (tracing started inside a call) are skipped
+        if not stack or stack[-1][0] != fn:
+            continue
+        f, start, child = stack.pop()
+        if stack:
+            stack[-1][2] += ticks - start
+        yield f, (stack[-1][0] if stack else None), start, ticks, child
+    while stack:   # still running at exit (e.g. main when exit() was called inside it)
+        f, start, child = stack.pop()
+        if stack:
+            stack[-1][2] += last - start
+        yield f, (stack[-1][0] if stack else None), start, last, child
+
+
+def aggregate(threads):
+    stats = defaultdict(lambda: [0, 0, 0])          # fn -> [calls, inclusive, exclusive]
+    edges = defaultdict(lambda: [0, 0])             # (caller, callee) -> [calls, inclusive]
+    for events in threads.values():
+        for fn, caller, start, end, child in calls(events):
+            s = stats[fn]
+            s[0] += 1
+            s[1] += end - start
+            s[2] += end - start - child
+            if caller is not None:
+                e = edges[(caller, fn)]
+                e[0] += 1
+                e[1] += end - start
+    return stats, edges
+
+
+def to_summary(tps, overhead, threads, names):
+    stats, _ = aggregate(threads)
+    ns = 1e9 / tps
+    total_calls = sum(s[0] for s in stats.values())
+    print("tracer overhead: %.1f ns per call (enter+exit), %d calls, %.3f ms total"
+          % (overhead * ns, total_calls, total_calls * overhead * ns / 1e6))
+    print("%12s %14s %14s %14s  %s" % ("calls", "incl ms", "self ms", "self-ovh ms", "function"))
+    for fn, (n, inc, exc) in sorted(stats.items(), key=lambda kv: -kv[1][2]):
+        print("%12d %14.3f %14.3f %14.3f  %s" % (n, inc * ns / 1e6, exc * ns / 1e6,
+                                                  max(0.0, exc - n * overhead) * ns / 1e6,
+                                                  name_of(names, fn)))
+
+
+def to_chrome(tps, threads, names, out_path):
+    t0 = min((ev[0][0] for ev in threads.values() if ev), default=0)
+    us = 1e6 / tps
+    events = []
+    for tid, evs in threads.items():
+        for ticks, fn, is_exit in evs:
+            events.append({"name": name_of(names, fn), "ph": "E" if is_exit else "B",
+                           "ts": (ticks - t0) * us, "pid": 1, "tid": tid})
+    with open(out_path, "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, f)
+
+
+def to_callgrind(tps, overhead, threads, names, out_path):
+    stats, edges = aggregate(threads)
+    ns = 1e9 / tps
+    by_caller = defaultdict(list)
+    for (caller, callee), e in edges.items():
+        by_caller[caller].append((callee, e))
+    with open(out_path, "w") as f:
+        f.write("version: 1\ncreator: tracer\npositions: line\nevents: ns\n\n")
+        for fn, (n, inc, exc) in stats.items():
+            f.write("fn=%s\n0 %d\n" % (name_of(names, fn), exc * ns))
+            for callee, (calls_n, inc_e) in by_caller[fn]:
+                f.write("cfn=%s\ncalls=%d 0\n0 %d\n" % (name_of(names, callee), calls_n, inc_e * ns))
+            f.write("\n")
+
+
+def main():
+    if len(sys.argv) < 3 or sys.argv[2] not in ("summary", "chrome", "callgrind") \
+            or (sys.argv[2] != "summary" and len(sys.argv) < 4):
+        print("usage: trace_convert.py <trace> summary | chrome <out.json> | callgrind <out>",
+              file=sys.stderr)
+        sys.exit(1)
+    tps, overhead, threads, names = read_trace(sys.argv[1])
+    if sys.argv[2] == "summary":
+        to_summary(tps, overhead, threads, names)
+    elif sys.argv[2] == "chrome":
+        to_chrome(tps, threads, names, sys.argv[3])
+    else:
+        to_callgrind(tps, overhead, threads, names, sys.argv[3])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,241 @@
+// Function tracer for programs built with -finstrument-functions, see readme.md.
+//
+// __cyg_profile_func_enter/exit append 16-byte events (TSC, function address | exit bit) to a
+// per-thread buffer; full buffers are written to the trace file as chunks. At exit the
+// addresses found in the trace are symbolized and appended to the same file.
+//
+// This file itself must be compiled WITHOUT -finstrument-functions:
+//   g++ -O2 -c tracer.cpp -o tracer.o
+//   g++ -O0 -finstrument-functions -rdynamic ../1.cpp tracer.o -o prog -ldl -lpthread
+//   TRACER_OUT=prog.trace ./prog
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../sampler/symbolize.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define NO_TRACE __attribute__((no_instrument_function))
+
+namespace {
+
+// File layout (little endian):
+//   header: "FTRC", u32 version, f64 ticks_per_second, f64 overhead_ticks (per enter+exit pair)
+//   records: u32 tag
+//     TAG_CHUNK:   u32 tid, u32 count, count * {u64 ticks, u64 fn | EXIT_BIT}
+//     TAG_SYMBOLS: u32 count, count * {u64 fn, u32 len, char name[len]}
+const uint32_t VERSION = 1;
+const uint32_t TAG_CHUNK = 1;
+const uint32_t TAG_SYMBOLS = 2;
+const uint64_t EXIT_BIT = 1ULL << 63;
+const size_t CHUNK_EVENTS = 1 << 16;
+
+struct Event {
+    uint64_t ticks;
+    uint64_t fn;
+};
+
+NO_TRACE inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+std::mutex g_file_mutex;
+FILE* g_file = nullptr;
+std::atomic<bool> g_enabled{false};   // read by every enter/exit of every thread, relaxed
+const char* g_path = nullptr;
+
+struct ThreadBuf {
+    Event events[CHUNK_EVENTS];
+    uint32_t count = 0;
+    uint32_t tid = 0;
+
+    NO_TRACE void flush() {
+        if (count == 0)
+            return;
+        std::lock_guard<std::mutex> lock(g_file_mutex);
+        if (g_file) {
+            fwrite(&TAG_CHUNK, sizeof(TAG_CHUNK), 1, g_file);
+            fwrite(&tid, sizeof(tid), 1, g_file);
+            fwrite(&count, sizeof(count), 1, g_file);
+            fwrite(events, sizeof(Event), count, g_file);
+        }
+        count = 0;
+    }
+    NO_TRACE ~ThreadBuf() {
+        flush();
+    }
+};
+
+// Heap-allocated per thread: the 1 MiB buffer would not fit in static TLS.
+// The pointer is a plain TLS variable, so it can still be read (as nullptr) after
+// the reaper has run at thread exit; a store to a member in the reaper's own
+// destructor could be dropped by the compiler.
+thread_local ThreadBuf* tls_buf = nullptr;
+thread_local bool tls_busy = false;
+
+struct ThreadBufReaper {
+    bool armed = false;
+    NO_TRACE ~ThreadBufReaper() {
+        ThreadBuf* b = tls_buf;
+        tls_buf = nullptr;
+        delete b;
+    }
+};
+
+thread_local ThreadBufReaper tls_reaper;
+
+NO_TRACE inline void record(void* fn, uint64_t kind) {
+    if (!g_enabled.load(std::memory_order_relaxed) || tls_busy)
+        return;
+    ThreadBuf* b = tls_buf;
+    if (!b) {
+        tls_busy = true;   // allocation below must not be traced
+        b = tls_buf = new ThreadBuf;
+        tls_reaper.armed = true;   // registers the thread exit destructor
+        b->tid = (uint32_t)syscall(SYS_gettid);
+        tls_busy = false;
+    }
+    b->events[b->count].ticks = ticks();
+    b->events[b->count].fn = (uint64_t)(uintptr_t)fn | kind;
+    if (++b->count == CHUNK_EVENTS) {
+        tls_busy = true;
+        b->flush();
+        tls_busy = false;
+    }
+}
+
+NO_TRACE double calibrate_ticks_per_second() {
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = ticks();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(20))
+        ;
+    uint64_t c1 = ticks();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return (c1 - c0) / s;
+}
+
+// Cost of one enter+exit pair, measured on a scratch buffer that is never written out.
+NO_TRACE double calibrate_overhead() {
+    const int N = 100000;
+    ThreadBuf* scratch = new ThreadBuf;
+    memset(scratch->events, 0, sizeof(scratch->events));   // page faults are not the tracer's cost
+    ThreadBuf* saved = tls_buf;
+    tls_buf = scratch;
+    bool was = g_enabled.load(std::memory_order_relaxed);
+    g_enabled.store(true, std::memory_order_relaxed);
+    uint64_t t0 = ticks();
+    for (int i = 0; i < N; i++) {
+        record((void*)&calibrate_overhead, 0);
+        record((void*)&calibrate_overhead, EXIT_BIT);
+        if (scratch->count > CHUNK_EVENTS - 4)
+            scratch->count = 0;
+    }
+    uint64_t t1 = ticks();
+    g_enabled.store(was, std::memory_order_relaxed);
+    tls_buf = saved;
+    scratch->count = 0;
+    delete scratch;
+    return (double)(t1 - t0) / N;
+}
+
+// Re-reads the chunks written so far to find the set of traced functions.
+NO_TRACE void write_symbols() {
+    std::set<uint64_t> fns;
+    FILE* in = fopen(g_path, "rb");
+    if (!in)
+        return;
+    fseek(in, 4 + sizeof(uint32_t) + 2 * sizeof(double), SEEK_SET);
+    uint32_t tag, tid, count;
+    std::vector<Event> events;
+    while (fread(&tag, sizeof(tag), 1, in) == 1 && tag == TAG_CHUNK) {
+        if (fread(&tid, sizeof(tid), 1, in) != 1 || fread(&count, sizeof(count), 1, in) != 1)
+            break;
+        events.resize(count);
+        if (fread(events.data(), sizeof(Event), count, in) != count)
+            break;
+        for (auto& e : events)
+            fns.insert(e.fn & ~EXIT_BIT);
+    }
+    fclose(in);
+
+    uint32_t n = fns.size();
+    fwrite(&TAG_SYMBOLS, sizeof(TAG_SYMBOLS), 1, g_file);
+    fwrite(&n, sizeof(n), 1, g_file);
+    for (uint64_t fn : fns) {
+        std::string name = symbols::symbolize(fn);
+        uint32_t len = name.size();
+        fwrite(&fn, sizeof(fn), 1, g_file);
+        fwrite(&len, sizeof(len), 1, g_file);
+        fwrite(name.data(), 1, len, g_file);
+    }
+}
+
+NO_TRACE void tracer_finish() {
+    tls_busy = true;
+    g_enabled.store(false, std::memory_order_relaxed);
+    if (tls_buf)
+        tls_buf->flush();   // other threads have flushed at their exit
+    std::lock_guard<std::mutex> lock(g_file_mutex);
+    if (!g_file)
+        return;
+    fflush(g_file);
+    write_symbols();
+    fclose(g_file);
+    g_file = nullptr;
+}
+
+__attribute__((constructor)) NO_TRACE void tracer_init() {
+    g_path = getenv("TRACER_OUT");
+    if (!g_path)
+        g_path = "trace.bin";
+    g_file = fopen(g_path, "wb");
+    if (!g_file) {
+        perror(g_path);
+        return;
+    }
+    double tps = calibrate_ticks_per_second();
+    double overhead = calibrate_overhead();
+    fwrite("FTRC", 1, 4, g_file);
+    fwrite(&VERSION, sizeof(VERSION), 1, g_file);
+    fwrite(&tps, sizeof(tps), 1, g_file);
+    fwrite(&overhead, sizeof(overhead), 1, g_file);
+    g_enabled.store(true, std::memory_order_relaxed);
+    atexit(tracer_finish);
+}
+
+} // namespace
+
+extern "C" {
+
+NO_TRACE void __cyg_profile_func_enter(void* fn, void*) {
+    record(fn, 0);
+}
+
+NO_TRACE void __cyg_profile_func_exit(void* fn, void*) {
+    record(fn, EXIT_BIT);
+}
+
+} // extern "C"
@@ -0,0 +1,154 @@
+// An update loop over 10^7 weapons of random types: attack with every weapon, then reload every magazine.
+// Virtual calls through unique_ptr (as action(Weapon&) of ../1_weapons.cpp), a vector of std::variant with std::visit
+// (both also with the objects sorted by type), and CRTP types in one vector per type (runner of ../../seminar10/bench).
+//   g++ -O2 -std=c++17 dispatch_bench.cpp -o dispatch_bench && ./dispatch_bench
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "weapons.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+constexpr size_t COUNT = 10000000;
+
+enum Kind { KNIFE, SHOTGUN, AK };
+
+static std::vector<Kind> kinds(size_t n) {
+    std::mt19937 rng(1);
+    std::vector<Kind> k(n);
+    for (Kind& x : k)
+        x = Kind(rng() % 3);
+    return k;
+}
+
+struct VirtualArmory {
+    std::vector<std::unique_ptr<virt::Weapon>> weapons;
+    std::vector<virt::Magazine*> magazines;
+
+    explicit VirtualArmory(const std::vector<Kind>& ks) {
+        for (Kind k : ks) {
+            if (k == KNIFE) {
+                weapons.push_back(std::make_unique<virt::Knife>());
+            } else {
+                virt::Shotgun* s = k == SHOTGUN ? new virt::Shotgun : new virt::AK;
+                weapons.emplace_back(s);
+                magazines.push_back(s);
+            }
+        }
+    }
+
+    unsigned tick() {
+        unsigned damage = 0;
+        for (auto& w : weapons)
+            damage += virt::action(*w);
+        for (virt::Magazine* m : magazines)
+            virt::fillMagazine(*m);
+        return damage;
+    }
+};
+
+struct VariantArmory {
+    std::vector<closed::Weapon> weapons;
+
+    explicit VariantArmory(const std::vector<Kind>& ks) {
+        weapons.reserve(ks.size());
+        for (Kind k : ks) {
+            if (k == KNIFE)
+                weapons.emplace_back(closed::Knife());
+            else if (k == SHOTGUN)
+                weapons.emplace_back(closed::Shotgun());
+            else
+                weapons.emplace_back(closed::AK());
+        }
+    }
+
+    unsigned tick() {
+        unsigned damage = 0;
+        for (closed::Weapon& w : weapons)
+            damage += closed::action(w);
+        for (closed::Weapon& w : weapons)
+            closed::fillMagazine(w);
+        return damage;
+    }
+};
+
+// the same objects created in the order of their types: every call site sees one type after another
+struct SortedVirtualArmory : VirtualArmory {
+    explicit SortedVirtualArmory(std::vector<Kind> ks) : VirtualArmory((std::sort(ks.begin(), ks.end()), ks)) {}
+};
+
+struct SortedVariantArmory : VariantArmory {
+    explicit SortedVariantArmory(std::vector<Kind> ks) : VariantArmory((std::sort(ks.begin(), ks.end()), ks)) {}
+};
+
+// one vector per type: the loops over each are monomorphic and inline the calls
+struct CrtpArmory {
+    std::tuple<std::vector<crtp::Knife>, std::vector<crtp::Shotgun>, std::vector<crtp::AK>> weapons;
+
+    explicit CrtpArmory(const std::vector<Kind>& ks) {
+        for (Kind k : ks) {
+            if (k == KNIFE)
+                std::get<0>(weapons).emplace_back();
+            else if (k == SHOTGUN)
+                std::get<1>(weapons).emplace_back();
+            else
+                std::get<2>(weapons).emplace_back();
+        }
+    }
+
+    unsigned tick() {
+        unsigned damage = 0;
+        std::apply([&](auto&... v) { ((damage += attack_all(v)), ...); }, weapons);
+        for (crtp::Shotgun& s : std::get<1>(weapons))
+            crtp::fillMagazine(s);
+        for (crtp::AK& a : std::get<2>(weapons))
+            crtp::fillMagazine(a);
+        return damage;
+    }
+
+    template <class W>
+    static unsigned attack_all(std::vector<W>& v) {
+        unsigned damage = 0;
+        for (W& w : v)
+            damage += crtp::action(w);
+        return damage;
+    }
+};
+
+// built once: 10^7 objects take seconds to allocate
+template <class Armory>
+static Armory& armory() {
+    static Armory a(kinds(COUNT));
+    return a;
+}
+
+template <class Armory>
+static void bm_tick(bench::State& st) {
+    Armory& a = armory<Armory>();
+    while (st.keep_running())
+        bench::do_not_optimize(a.tick());
+    st.set_items_per_iteration(COUNT);
+}
+
+BENCH(bm_tick<VirtualArmory>);
+BENCH(bm_tick<SortedVirtualArmory>);
+BENCH(bm_tick<VariantArmory>);
+BENCH(bm_tick<SortedVariantArmory>);
+BENCH(bm_tick<CrtpArmory>);
+
+int main(int argc, char** argv) {
+    // the same damage from every version, from new objects (empty magazines) over a few ticks
+    std::vector<Kind> ks = kinds(100000);
+    VirtualArmory v(ks);
+    VariantArmory var(ks);
+    CrtpArmory c(ks);
+    for (int t = 0; t < 3; t++) {
+        unsigned dv = v.tick(), dvar = var.tick(), dc = c.tick();
+        printf("tick %d damage: virtual %u, variant %u, crtp %u\n", t, dv, dvar, dc);
+        if (dv != dvar || dv != dc)
+            return 1;
+    }
+    return bench::run_all(argc, argv);
+}
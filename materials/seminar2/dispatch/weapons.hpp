@@ -0,0 +1,151 @@
+// The weapons of ../1_weapons.cpp three times: virtual functions, a closed set in std::variant, and CRTP.
+// See readme.md.
+//
+// The output of 1_weapons.cpp becomes state, so that the calls do work the compiler cannot drop:
+//   Knife    attack: 1 damage, no magazine;
+//   Shotgun  attack: 8 damage per shell, 0 if empty; reload: 2 shells;
+//   AK       attack: 3 damage per round, 0 if empty; reload: 30 rounds (an AK is a Shotgun, as in 1_weapons.cpp).
+// The three versions behave the same: the same sequence of calls gives the same damage.
+#ifndef WEAPONS_HPP
+#define WEAPONS_HPP
+
+#include <type_traits>
+#include <variant>
+
+// virtual calls, the hierarchy of 1_weapons.cpp
+namespace virt {
+
+class Weapon {
+public:
+    virtual ~Weapon() = default;
+    virtual unsigned attack() = 0;
+};
+
+class Magazine {
+public:
+    virtual ~Magazine() = default;
+    virtual void reload() = 0;
+    unsigned num = 0;
+};
+
+class Knife : public Weapon {
+public:
+    unsigned attack() override { return hit(); }
+
+private:
+    unsigned hit() { return 1; }
+};
+
+class Shotgun : public Weapon, public Magazine {
+public:
+    unsigned attack() override { return num ? (num--, 8) : 0; }
+    void reload() override { num = 2; }
+};
+
+class AK : public Shotgun {
+public:
+    unsigned attack() override { return num ? (num--, 3) : 0; }
+    void reload() override { num = 30; }
+};
+
+inline unsigned action(Weapon& w) { return w.attack(); }
+inline void fillMagazine(Magazine& m) { m.reload(); }
+
+} // namespace virt
+
+// a closed set: no base class, no vtable, the type is the index of the variant; std::visit switches on it and the
+// calls inline
+namespace closed {
+
+struct Knife {
+    unsigned attack() { return 1; }
+};
+
+struct Shotgun {
+    unsigned num = 0;
+    unsigned attack() { return num ? (num--, 8) : 0; }
+    void reload() { num = 2; }
+};
+
+struct AK {
+    unsigned num = 0;
+    unsigned attack() { return num ? (num--, 3) : 0; }
+    void reload() { num = 30; }
+};
+
+using Weapon = std::variant<Knife, Shotgun, AK>;
+
+inline unsigned action(Weapon& w) {
+    return std::visit([](auto& x) { return x.attack(); }, w);
+}
+
+template <class T, class = void>
+struct has_magazine : std::false_type {};
+template <class T>
+struct has_magazine<T, std::void_t<decltype(std::declval<T&>().reload())>> : std::true_type {};
+
+/** Reloads w if it has a magazine (a Knife has none: in 1_weapons.cpp it is not a Magazine). */
+inline void fillMagazine(Weapon& w) {
+    std::visit(
+        [](auto& x) {
+            if constexpr (has_magazine<std::decay_t<decltype(x)>>::value)
+                x.reload();
+        },
+        w);
+}
+
+} // namespace closed
+
+// static polymorphism: the base calls the derived class directly, so there is one action() per type and no common
+// type; objects of different types live in separate containers (see Armory in dispatch_bench.cpp)
+namespace crtp {
+
+template <class Derived>
+class Weapon {
+public:
+    unsigned attack() { return self().do_attack(); }
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+template <class Derived>
+class Magazine {
+public:
+    void reload() { static_cast<Derived&>(*this).do_reload(); }
+    unsigned num = 0;
+};
+
+class Knife : public Weapon<Knife> {
+    friend class Weapon<Knife>;
+    unsigned do_attack() { return 1; }
+};
+
+class Shotgun : public Weapon<Shotgun>, public Magazine<Shotgun> {
+    friend class Weapon<Shotgun>;
+    friend class Magazine<Shotgun>;
+    unsigned do_attack() { return num ? (num--, 8) : 0; }
+    void do_reload() { num = 2; }
+};
+
+// not derived from Shotgun: Weapon<Shotgun> would dispatch an AK to the Shotgun functions
+class AK : public Weapon<AK>, public Magazine<AK> {
+    friend class Weapon<AK>;
+    friend class Magazine<AK>;
+    unsigned do_attack() { return num ? (num--, 3) : 0; }
+    void do_reload() { num = 30; }
+};
+
+template <class D>
+unsigned action(Weapon<D>& w) {
+    return w.attack();
+}
+
+template <class D>
+void fillMagazine(Magazine<D>& m) {
+    m.reload();
+}
+
+} // namespace crtp
+
+#endif // WEAPONS_HPP
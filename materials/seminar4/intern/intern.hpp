@@ -0,0 +1,246 @@
+// String interning: every distinct string is stored once, records keep 32-bit handles, see readme.md.
+//
+// Bytes live in an append-only arena (one reserved virtual range, so they never move and a handle is just
+// an offset / 8). The index is an open-addressing table of 64-bit slots (32 bits of hash | handle):
+// lookups of existing strings are lock-free, inserts are serialized by a mutex. A full table is replaced by
+// a twice larger copy; old tables stay readable until the pool dies, so a lookup racing with the resize
+// either finds the string in the old table or takes the locked path and finds it in the new one.
+#ifndef INTERN_HPP
+#define INTERN_HPP
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace intern {
+
+/** Id of an interned string; equal strings of one pool have equal handles. 0 is "no string". */
+struct Handle {
+    uint32_t id = 0;
+
+    explicit operator bool() const { return id != 0; }
+    friend bool operator==(Handle a, Handle b) { return a.id == b.id; }
+    friend bool operator!=(Handle a, Handle b) { return a.id != b.id; }
+};
+
+inline uint64_t hash_bytes(const char* p, size_t n) {
+    // 8 bytes per step with a multiply-xorshift mix; the tail is read as one partial word
+    const uint64_t K = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = n * K;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * K;
+        h ^= h >> 29;
+    }
+    if (n) {
+        uint64_t w = 0;
+        memcpy(&w, p, n);
+        h = (h ^ w) * K;
+    }
+    h ^= h >> 32;
+    h *= K;
+    return h ^ (h >> 29);
+}
+
+class Pool {
+public:
+    static constexpr size_t ALIGN = 8;   // arena granularity: handles address 8-byte units
+
+    /**
+     * @param arena_bytes virtual address space reserved for the strings (pages are committed on use),
+     *        at most 32 GiB, the range of 32-bit handles in 8-byte units.
+     * @param expected number of distinct strings the first table is sized for.
+     */
+    explicit Pool(size_t arena_bytes = size_t(4) << 30, size_t expected = 1 << 16) : arena_size_(arena_bytes) {
+        if (arena_bytes > (size_t(1) << 32) * ALIGN)
+            throw std::invalid_argument("intern::Pool: arena larger than 32 GiB");
+        void* p = mmap(nullptr, arena_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                       -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        arena_ = (char*)p;
+        used_ = ALIGN;   // offset 0 is the null handle
+        size_t cap = 16;
+        while (cap < 2 * expected)
+            cap *= 2;
+        tables_.push_back(std::make_unique<Table>(cap));
+        table_.store(tables_.back().get(), std::memory_order_release);
+    }
+
+    ~Pool() { munmap(arena_, arena_size_); }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /** Returns the handle of s, storing s if it is new. Thread-safe. */
+    Handle intern(std::string_view s) {
+        uint64_t h = hash_bytes(s.data(), s.size());
+        if (Handle found = lookup(table_.load(std::memory_order_acquire), s, h))
+            return found;
+        std::lock_guard<std::mutex> lock(mutex_);
+        Table* t = table_.load(std::memory_order_relaxed);
+        if (Handle found = lookup(t, s, h))   // inserted by another thread meanwhile
+            return found;
+        if (2 * (count_ + 1) > t->mask + 1)
+            t = grow(t);
+        Handle handle = store(s);
+        size_t i = h & t->mask;
+        while (t->slots[i].load(std::memory_order_relaxed) != 0)
+            i = (i + 1) & t->mask;
+        t->slots[i].store(pack(h, handle), std::memory_order_release);
+        count_++;
+        return handle;
+    }
+
+    /** Handle of s if it was interned, a null handle otherwise; never stores. */
+    Handle find(std::string_view s) const {
+        uint64_t h = hash_bytes(s.data(), s.size());
+        if (Handle found = lookup(table_.load(std::memory_order_acquire), s, h))
+            return found;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lookup(table_.load(std::memory_order_relaxed), s, h);
+    }
+
+    /** The interned string, valid (and NUL-terminated) as long as the pool lives. O(1), no locks. */
+    std::string_view view(Handle h) const {
+        const char* p = arena_ + size_t(h.id) * ALIGN;
+        uint32_t len;
+        memcpy(&len, p, sizeof(len));
+        return std::string_view(p + sizeof(len), len);
+    }
+
+    /** Number of distinct strings. */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    /** Arena bytes in use plus the current and retired tables. */
+    size_t memory_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t bytes = used_;
+        for (const auto& t : tables_)
+            bytes += (t->mask + 1) * sizeof(uint64_t);
+        return bytes;
+    }
+
+private:
+    struct Table {
+        explicit Table(size_t cap) : mask(cap - 1), slots(new std::atomic<uint64_t>[cap]) {
+            for (size_t i = 0; i < cap; i++)
+                slots[i].store(0, std::memory_order_relaxed);
+        }
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;   // 0 = empty, else hash >> 32 << 32 | handle
+    };
+
+    static uint64_t pack(uint64_t hash, Handle h) { return (hash & 0xFFFFFFFF00000000ULL) | h.id; }
+
+    Handle lookup(const Table* t, std::string_view s, uint64_t h) const {
+        uint64_t tag = h & 0xFFFFFFFF00000000ULL;
+        for (size_t i = h & t->mask;; i = (i + 1) & t->mask) {
+            uint64_t slot = t->slots[i].load(std::memory_order_acquire);
+            if (slot == 0)
+                return Handle{};
+            if ((slot & 0xFFFFFFFF00000000ULL) == tag) {
+                Handle cand{uint32_t(slot)};
+                if (view(cand) == s)
+                    return cand;
+            }
+        }
+    }
+
+    // under mutex_: [u32 length][bytes]['\0'] at an 8-byte boundary of the arena
+    Handle store(std::string_view s) {
+        if (s.size() > UINT32_MAX)
+            throw std::length_error("intern::Pool: string too long");
+        size_t need = (sizeof(uint32_t) + s.size() + 1 + ALIGN - 1) / ALIGN * ALIGN;
+        if (used_ + need > arena_size_)
+            throw std::bad_alloc();
+        char* p = arena_ + used_;
+        uint32_t len = (uint32_t)s.size();
+        memcpy(p, &len, sizeof(len));
+        memcpy(p + sizeof(len), s.data(), s.size());
+        p[sizeof(len) + s.size()] = '\0';
+        Handle h{uint32_t(used_ / ALIGN)};
+        used_ += need;
+        return h;
+    }
+
+    // under mutex_: rehashes into a table twice as large; the old one stays for concurrent readers
+    Table* grow(Table* old) {
+        auto t = std::make_unique<Table>(2 * (old->mask + 1));
+        for (size_t i = 0; i <= old->mask; i++) {
+            uint64_t slot = old->slots[i].load(std::memory_order_relaxed);
+            if (slot == 0)
+                continue;
+            std::string_view s = view(Handle{uint32_t(slot)});
+            size_t j = hash_bytes(s.data(), s.size()) & t->mask;
+            while (t->slots[j].load(std::memory_order_relaxed) != 0)
+                j = (j + 1) & t->mask;
+            t->slots[j].store(slot, std::memory_order_relaxed);
+        }
+        tables_.push_back(std::move(t));
+        table_.store(tables_.back().get(), std::memory_order_release);
+        return tables_.back().get();
+    }
+
+    char* arena_;
+    size_t arena_size_;
+    size_t used_;
+    size_t count_ = 0;
+    std::atomic<Table*> table_;
+    std::vector<std::unique_ptr<Table>> tables_;   // the current one is last
+    mutable std::mutex mutex_;
+};
+
+/** The process-wide pool used by Symbol. */
+inline Pool& global() {
+    static Pool pool;
+    return pool;
+}
+
+/**
+ * An interned string of the global pool: 4 bytes, O(1) copy and equality, view() without locks.
+ * A drop-in for std::string fields that hold a few distinct values repeated many times.
+ */
+class Symbol {
+public:
+    Symbol() = default;
+    explicit Symbol(std::string_view s) : h_(global().intern(s)) {}
+
+    std::string_view view() const { return h_ ? global().view(h_) : std::string_view(); }
+    const char* c_str() const { return h_ ? global().view(h_).data() : ""; }
+    Handle handle() const { return h_; }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.h_ == b.h_; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.h_ != b.h_; }
+
+private:
+    Handle h_;
+};
+
+} // namespace intern
+
+template <>
+struct std::hash<intern::Handle> {
+    size_t operator()(intern::Handle h) const noexcept { return h.id * 0x9E3779B97F4A7C15ULL >> 32; }
+};
+
+template <>
+struct std::hash<intern::Symbol> {
+    size_t operator()(intern::Symbol s) const noexcept { return std::hash<intern::Handle>()(s.handle()); }
+};
+
+#endif // INTERN_HPP
@@ -0,0 +1,108 @@
+// Records of ../../seminar2/8_friend.cpp (a person's name and a car's name) with std::string fields
+// and with interned Symbols: memory per record, and intern() throughput from 1 to 16 threads.
+//   g++ -O2 -std=c++17 -pthread intern_bench.cpp -o intern_bench
+//   ./intern_bench [records = 4000000] [distinct names = 10000]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "intern.hpp"
+
+// bytes allocated by malloc (and operator new on top of it) and not freed, large blocks are mmapped
+static size_t heap_bytes() {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+struct Record {            // Person + Auto of 8_friend.cpp
+    std::string person;
+    std::string car;
+    int price;
+};
+
+struct InternedRecord {
+    intern::Symbol person;
+    intern::Symbol car;
+    int price;
+};
+
+static std::vector<std::string> make_names(size_t n, std::mt19937& rng) {
+    static const char* cars[] = {"Tesla", "Toyota Corolla", "Volkswagen Golf", "Mercedes-Benz E-Class"};
+    std::vector<std::string> v;
+    for (size_t i = 0; i < n; i++) {
+        std::string s = cars[i % 4];
+        s += " #" + std::to_string(rng() % 1000000);   // 8 to 28 characters: short and long strings
+        v.push_back(s);
+    }
+    return v;
+}
+
+int main(int argc, char** argv) {
+    size_t records = argc > 1 ? atol(argv[1]) : 4000000;
+    size_t distinct = argc > 2 ? atol(argv[2]) : 10000;
+    std::mt19937 rng(1);
+    std::vector<std::string> names = make_names(distinct, rng);
+    std::vector<uint32_t> pick(2 * records);
+    for (auto& x : pick)
+        x = rng() % distinct;
+
+    size_t before = heap_bytes();
+    {
+        std::vector<Record> v;
+        v.reserve(records);
+        for (size_t i = 0; i < records; i++)
+            v.push_back(Record{names[pick[2 * i]], names[pick[2 * i + 1]], 5000});
+        size_t bytes = heap_bytes() - before;
+        printf("std::string records: %6.1f bytes/record (%zu MiB)\n", double(bytes) / records, bytes >> 20);
+    }
+    before = heap_bytes();
+    {
+        std::vector<InternedRecord> v;
+        v.reserve(records);
+        for (size_t i = 0; i < records; i++)
+            v.push_back(InternedRecord{intern::Symbol(names[pick[2 * i]]), intern::Symbol(names[pick[2 * i + 1]]), 5000});
+        size_t bytes = heap_bytes() - before + intern::global().memory_bytes();
+        printf("interned records:    %6.1f bytes/record (%zu MiB, pool %zu KiB for %zu strings)\n",
+               double(bytes) / records, bytes >> 20, intern::global().memory_bytes() >> 10, intern::global().size());
+    }
+
+    // lookups of existing strings, the steady state of a loader
+    printf("\n%8s %16s\n", "threads", "M interns/s");
+    const size_t per_thread = 2000000;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        std::vector<std::thread> pool;
+        std::atomic<uint64_t> sink{0};
+        auto t0 = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&, t] {
+                uint64_t sum = 0;
+                for (size_t i = 0; i < per_thread; i++)
+                    sum += intern::global().intern(names[pick[(t * per_thread + i) % pick.size()]]).id;
+                sink += sum;
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("%8d %16.1f\n", threads, threads * per_thread / s / 1e6);
+    }
+
+    // comparisons: std::string == vs handle ==
+    std::vector<intern::Symbol> syms;
+    for (const auto& s : names)
+        syms.emplace_back(s);
+    for (int pass = 0; pass < 2; pass++) {
+        auto t0 = std::chrono::steady_clock::now();
+        size_t eq = 0;
+        for (size_t i = 0; i + 1 < pick.size(); i++)
+            eq += pass ? syms[pick[i]] == syms[pick[i + 1]] : names[pick[i]] == names[pick[i + 1]];
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        printf("%s ==: %.2f ns (%zu equal)\n", pass ? "Symbol     " : "std::string", s * 1e9 / pick.size(), eq);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// The String of ../move_sem_1.cpp with counters instead of cout, its main, and a vector of a type whose move
+// constructor is not noexcept: the report shows the copies and print_copy_sites shows where they come from.
+//   g++ -O2 -std=c++17 -rdynamic example.cpp -o example && ./example
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "lifecycle.hpp"
+
+class String : public lifecycle::Counted<String> {
+public:
+    size_t size = 0;
+    char* c_string = nullptr;
+
+    String() = default;
+
+    explicit String(const char* c_str) : size(strlen(c_str)), c_string(alloc(size)) {
+        memcpy(c_string, c_str, size + 1);
+    }
+
+    String(const String& other) : Counted(other), size(other.size), c_string(alloc(size)) {
+        memcpy(c_string, other.c_string, size + 1);
+    }
+
+    String(String&& other) noexcept
+        : Counted(std::move(other)), size(std::exchange(other.size, 0)), c_string(std::exchange(other.c_string, nullptr)) {}
+
+    String& operator=(String&& other) noexcept {
+        Counted::operator=(std::move(other));
+        std::swap(size, other.size);
+        std::swap(c_string, other.c_string);
+        return *this;
+    }
+
+    String& operator=(const String& other) {
+        Counted::operator=(other);
+        String tmp(other.c_string);
+        std::swap(size, tmp.size);
+        std::swap(c_string, tmp.c_string);
+        return *this;
+    }
+
+    ~String() {
+        if (c_string) {
+            note_free();
+            delete[] c_string;
+        }
+    }
+
+private:
+    static char* alloc(size_t size) {
+        note_alloc(size + 1);
+        return new char[size + 1];
+    }
+};
+
+void f(String str) {
+    (void)str;
+}
+
+String F() {
+    return std::move(String(""));
+}
+
+// a user-declared move constructor without noexcept: std::vector copies on growth to keep its guarantee
+struct Record {
+    String name;
+    Record(const char* n) : name(n) {}
+    Record(const Record&) = default;
+    Record(Record&& o) : name(std::move(o.name)) {}
+};
+
+__attribute__((noinline)) void fill(std::vector<Record>& v, int n) {
+    for (int i = 0; i < n; i++)
+        v.emplace_back("record");
+}
+
+int main() {
+    // main of move_sem_1.cpp
+    String s = String("AAAAAAAAAA");
+    s = std::move(String("ABC"));
+    F();
+    f(s);
+    lifecycle::report();
+
+    lifecycle::trace_copies<String>();
+    std::vector<Record> v;
+    fill(v, 1000);
+    lifecycle::trace_copies<String>(false);
+    printf("\nafter 1000 emplace_back of Record:\n");
+    lifecycle::report();
+    printf("\n");
+    lifecycle::print_copy_sites<String>();
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Counters of special member calls and allocations per type, instead of the cout lines of ../move_sem_1.cpp.
+// See readme.md.
+//
+//     class String : public lifecycle::Counted<String> { ... };   // defaulted special members count themselves
+//
+//     lifecycle::Probe<String> probe;                            // counts of this thread from now on
+//     pipeline();
+//     assert(probe.delta().copies() == 0);
+//
+//     lifecycle::report();                                        // every counted type, all threads
+//
+// Counters are per thread (plain loads and stores, no atomic read-modify-write), a registry sums them for reports.
+#ifndef LIFECYCLE_HPP
+#define LIFECYCLE_HPP
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace lifecycle {
+
+enum Event {
+    OTHER_CTOR,   // default or any other non-copy, non-move constructor
+    COPY_CTOR,
+    MOVE_CTOR,
+    COPY_ASSIGN,
+    MOVE_ASSIGN,
+    DTOR,
+    ALLOCS,
+    ALLOC_BYTES,
+    FREES,
+    EVENTS
+};
+
+inline const char* event_name(int e) {
+    static const char* names[EVENTS] = {"ctor", "copy", "move", "copy=", "move=", "dtor", "allocs", "bytes",
+                                        "frees"};
+    return names[e];
+}
+
+/** A snapshot of the counters of one type. */
+struct Counts {
+    uint64_t n[EVENTS] = {};
+
+    uint64_t copies() const { return n[COPY_CTOR] + n[COPY_ASSIGN]; }
+    uint64_t moves() const { return n[MOVE_CTOR] + n[MOVE_ASSIGN]; }
+    uint64_t allocs() const { return n[ALLOCS]; }
+    uint64_t bytes() const { return n[ALLOC_BYTES]; }
+    /** Objects constructed and not destroyed. */
+    int64_t live() const { return int64_t(n[OTHER_CTOR] + n[COPY_CTOR] + n[MOVE_CTOR]) - int64_t(n[DTOR]); }
+
+    Counts operator-(const Counts& o) const {
+        Counts d;
+        for (int e = 0; e < EVENTS; e++)
+            d.n[e] = n[e] - o.n[e];
+        return d;
+    }
+    Counts& operator+=(const Counts& o) {
+        for (int e = 0; e < EVENTS; e++)
+            n[e] += o.n[e];
+        return *this;
+    }
+};
+
+namespace detail {
+
+inline std::string demangle(const char* sym) {
+    int status = 0;
+    char* d = abi::__cxa_demangle(sym, nullptr, nullptr, &status);
+    std::string r = status == 0 ? d : sym;
+    free(d);
+    return r;
+}
+
+// Written only by the owning thread; relaxed atomics so that reports from other threads are not data races
+struct ThreadCounts {
+    std::atomic<uint64_t> n[EVENTS] = {};
+
+    void add(Event e, uint64_t v = 1) { n[e].store(n[e].load(std::memory_order_relaxed) + v, std::memory_order_relaxed); }
+
+    Counts load() const {
+        Counts c;
+        for (int e = 0; e < EVENTS; e++)
+            c.n[e] = n[e].load(std::memory_order_relaxed);
+        return c;
+    }
+};
+
+struct TypeInfo;
+
+// Process-wide list of counted types; every type keeps the counters of live threads and of exited ones
+struct Registry {
+    std::mutex mutex;
+    std::vector<TypeInfo*> types;
+    std::map<void*, bool> copy_frames;   // return address -> inside a copy constructor or assignment, see copy_site
+
+    static Registry& instance() {
+        static Registry* r = new Registry;   // never destroyed: thread_local destructors may run after main
+        return *r;
+    }
+};
+
+struct TypeInfo {
+    std::string name;
+    std::vector<ThreadCounts*> threads;          // under Registry::mutex
+    Counts exited;
+    std::atomic<bool> trace{false};
+    std::map<void*, uint64_t> copy_sites;        // caller of the copy -> count, under Registry::mutex
+
+    explicit TypeInfo(const std::type_info& t) {
+        name = demangle(t.name());
+        Registry& r = Registry::instance();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.types.push_back(this);
+    }
+
+    Counts total() {
+        std::lock_guard<std::mutex> lock(Registry::instance().mutex);
+        Counts c = exited;
+        for (ThreadCounts* t : threads)
+            c += t->load();
+        return c;
+    }
+};
+
+template <class T>
+TypeInfo& type_info() {
+    static TypeInfo* info = new TypeInfo(typeid(T));   // lives as long as the registry
+    return *info;
+}
+
+// The calling thread's counters of T, registered on first use and folded into `exited` at thread exit
+template <class T>
+struct ThreadSlot {
+    ThreadCounts counts;
+
+    ThreadSlot() {
+        TypeInfo& info = type_info<T>();
+        std::lock_guard<std::mutex> lock(Registry::instance().mutex);
+        info.threads.push_back(&counts);
+    }
+    ~ThreadSlot() {
+        TypeInfo& info = type_info<T>();
+        std::lock_guard<std::mutex> lock(Registry::instance().mutex);
+        info.exited += counts.load();
+        info.threads.erase(std::find(info.threads.begin(), info.threads.end(), &counts));
+    }
+};
+
+template <class T>
+ThreadCounts& thread_counts() {
+    static thread_local ThreadSlot<T> slot;
+    return slot.counts;
+}
+
+// "X::X(X const&)" or "X::operator=(X const&)" of any X, from the demangled name
+inline bool is_copy_member(const std::string& sym) {
+    size_t paren = sym.find('(');
+    size_t colons = sym.rfind("::", paren);
+    if (paren == std::string::npos || colons == std::string::npos)
+        return false;
+    std::string cls = sym.substr(0, colons), member = sym.substr(colons + 2, paren - colons - 2);
+    if (sym.compare(paren, std::string::npos, "(" + cls + " const&)") != 0)
+        return false;
+    if (member == "operator=")
+        return true;
+    std::string plain = cls.substr(0, cls.find('<'));   // X<int>::X
+    size_t c = plain.rfind("::");
+    return member == (c == std::string::npos ? plain : plain.substr(c + 2));
+}
+
+// Under Registry::mutex: dladdr and the demangler run once per return address
+inline bool in_copy_member(void* frame) {
+    auto [it, added] = Registry::instance().copy_frames.try_emplace(frame, false);
+    if (added) {
+        Dl_info dl;
+        it->second = dladdr(frame, &dl) && dl.dli_sname && is_copy_member(demangle(dl.dli_sname));
+    }
+    return it->second;
+}
+
+// The caller of Counted's copy, or of the copy constructors and assignments above it: Derived's own copy
+// constructor, when it is not inlined, and those of the types that contain a Derived (a defaulted
+// Record(const Record&) copying its String) are not where the copy comes from. Without symbols (no -rdynamic) nothing
+// is recognized and the site is the caller of Counted.
+inline void* copy_site(void* caller) {
+    void* frames[32];
+    int n = backtrace(frames, 32);
+    int i = 0;
+    while (i < n && frames[i] != caller)
+        i++;
+    if (i == n)
+        return caller;
+    while (i + 1 < n && in_copy_member(frames[i]))
+        i++;
+    return frames[i];
+}
+
+template <class T>
+__attribute__((noinline)) void record_copy_site(void* caller) {
+    TypeInfo& info = type_info<T>();
+    std::lock_guard<std::mutex> lock(Registry::instance().mutex);
+    info.copy_sites[copy_site(caller)]++;
+}
+
+} // namespace detail
+
+/**
+ * Base class that counts the special member calls of Derived. Defaulted special members of Derived call these;
+ * user-written ones must call them explicitly (`String(const String& o) : Counted(o)`), otherwise a copy is
+ * counted as OTHER_CTOR. The moves are noexcept, so they do not make Derived's moves throwing.
+ */
+template <class Derived>
+class Counted {
+public:
+    Counted() noexcept { add(OTHER_CTOR); }
+    __attribute__((noinline)) Counted(const Counted&) noexcept {
+        add(COPY_CTOR);
+        trace_copy(__builtin_return_address(0));
+    }
+    Counted(Counted&&) noexcept { add(MOVE_CTOR); }
+    __attribute__((noinline)) Counted& operator=(const Counted&) noexcept {
+        add(COPY_ASSIGN);
+        trace_copy(__builtin_return_address(0));
+        return *this;
+    }
+    Counted& operator=(Counted&&) noexcept {
+        add(MOVE_ASSIGN);
+        return *this;
+    }
+    ~Counted() { add(DTOR); }
+
+protected:
+    /** To be called where Derived allocates / frees its buffers. */
+    static void note_alloc(size_t bytes) {
+        detail::ThreadCounts& c = detail::thread_counts<Derived>();
+        c.add(ALLOCS);
+        c.add(ALLOC_BYTES, bytes);
+    }
+    static void note_free() { add(FREES); }
+
+private:
+    static void add(Event e) { detail::thread_counts<Derived>().add(e); }
+
+    static void trace_copy(void* caller) {
+        if (detail::type_info<Derived>().trace.load(std::memory_order_relaxed))
+            detail::record_copy_site<Derived>(caller);
+    }
+};
+
+/** Counts of T summed over all threads (exact only for threads that are not counting at the moment). */
+template <class T>
+Counts totals() {
+    return detail::type_info<T>().total();
+}
+
+/** Counts of T made by the calling thread. */
+template <class T>
+Counts this_thread() {
+    return detail::thread_counts<T>().load();
+}
+
+/** Counts of T made by the calling thread since construction or reset(): the tool for assertions in tests. */
+template <class T>
+class Probe {
+public:
+    Probe() : start_(this_thread<T>()) {}
+    Counts delta() const { return this_thread<T>() - start_; }
+    void reset() { start_ = this_thread<T>(); }
+
+private:
+    Counts start_;
+};
+
+/**
+ * Records the caller of every copy of T: the first function on the stack that is not a copy constructor or copy
+ * assignment (T's own, or one of a type holding a T). print_copy_sites lists them with symbol names. Moves that
+ * silently became copies show up here. Needs -rdynamic to tell the copy members apart, and takes a backtrace per copy.
+ */
+template <class T>
+void trace_copies(bool on = true) {
+    detail::type_info<T>().trace.store(on);
+}
+
+template <class T>
+void print_copy_sites(FILE* out = stdout) {
+    detail::TypeInfo& info = detail::type_info<T>();
+    std::vector<std::pair<uint64_t, void*>> sites;
+    {
+        std::lock_guard<std::mutex> lock(detail::Registry::instance().mutex);
+        for (auto& [addr, n] : info.copy_sites)
+            sites.push_back({n, addr});
+    }
+    std::sort(sites.rbegin(), sites.rend());
+    fprintf(out, "copies of %s by call site:\n", info.name.c_str());
+    for (auto& [n, addr] : sites) {
+        Dl_info dl;
+        std::string sym = "?";
+        if (dladdr(addr, &dl) && dl.dli_sname)
+            sym = detail::demangle(dl.dli_sname);
+        fprintf(out, "%10llu  %p  %s\n", (unsigned long long)n, addr, sym.c_str());
+    }
+}
+
+/** A table of every counted type, all threads. */
+inline void report(FILE* out = stdout) {
+    std::vector<detail::TypeInfo*> types;
+    {
+        std::lock_guard<std::mutex> lock(detail::Registry::instance().mutex);
+        types = detail::Registry::instance().types;
+    }
+    fprintf(out, "%-24s", "type");
+    for (int e = 0; e < EVENTS; e++)
+        fprintf(out, " %10s", event_name(e));
+    fprintf(out, " %10s\n", "live");
+    for (detail::TypeInfo* t : types) {
+        Counts c = t->total();
+        fprintf(out, "%-24s", t->name.c_str());
+        for (int e = 0; e < EVENTS; e++)
+            fprintf(out, " %10llu", (unsigned long long)c.n[e]);
+        fprintf(out, " %10lld\n", (long long)c.live());
+    }
+}
+
+} // namespace lifecycle
+
+#endif // LIFECYCLE_HPP
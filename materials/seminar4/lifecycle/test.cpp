@@ -0,0 +1,176 @@
+// Checks of the counters, and the move_sem_1.cpp patterns written as assertions on a Probe.
+//   g++ -std=c++17 -fsanitize=address,undefined -pthread -rdynamic test.cpp -o test && ./test
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "lifecycle.hpp"
+
+struct Plain : lifecycle::Counted<Plain> {
+    int value = 0;
+};
+
+// a user-declared move constructor without noexcept
+struct ThrowingMove : lifecycle::Counted<ThrowingMove> {
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& o) : Counted(std::move(o)) {}
+};
+
+struct Buffer : lifecycle::Counted<Buffer> {
+    char* p = nullptr;
+    explicit Buffer(size_t n) : p(new char[n]) { note_alloc(n); }
+    Buffer(Buffer&& o) noexcept : Counted(std::move(o)), p(std::exchange(o.p, nullptr)) {}
+    ~Buffer() {
+        if (p) {
+            note_free();
+            delete[] p;
+        }
+    }
+};
+
+static void take(Plain p) { (void)p; }
+
+static Plain make_elided() { return Plain(); }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpessimizing-move"   // the pessimization is what is measured
+static Plain make_moved() {
+    Plain p;
+    return std::move(p);
+}
+#pragma GCC diagnostic pop
+
+static void test_special_members() {
+    lifecycle::Probe<Plain> probe;
+    {
+        Plain a;
+        Plain b(a);
+        Plain c(std::move(a));
+        b = c;
+        c = std::move(b);
+    }
+    lifecycle::Counts d = probe.delta();
+    assert(d.n[lifecycle::OTHER_CTOR] == 1);
+    assert(d.n[lifecycle::COPY_CTOR] == 1 && d.n[lifecycle::MOVE_CTOR] == 1);
+    assert(d.n[lifecycle::COPY_ASSIGN] == 1 && d.n[lifecycle::MOVE_ASSIGN] == 1);
+    assert(d.copies() == 2 && d.moves() == 2);
+    assert(d.n[lifecycle::DTOR] == 3 && d.live() == 0);
+}
+
+static void test_move_sem_patterns() {
+    lifecycle::Probe<Plain> probe;
+    Plain s;
+    take(s);
+    assert(probe.delta().copies() == 1);
+
+    probe.reset();
+    take(std::move(s));
+    assert(probe.delta().copies() == 0 && probe.delta().moves() == 1);
+
+    probe.reset();
+    take(Plain());   // the temporary is the parameter
+    assert(probe.delta().copies() == 0 && probe.delta().moves() == 0);
+
+    probe.reset();
+    Plain e = make_elided();
+    assert(probe.delta().moves() == 0 && probe.delta().n[lifecycle::OTHER_CTOR] == 1);
+
+    probe.reset();
+    Plain m = make_moved();   // return std::move(local) disables the elision
+    assert(probe.delta().moves() == 1);
+    (void)e, (void)m;
+}
+
+static void test_vector_growth() {
+    lifecycle::Probe<Plain> plain;
+    std::vector<Plain> a;
+    for (int i = 0; i < 100; i++)
+        a.emplace_back();
+    assert(plain.delta().copies() == 0 && plain.delta().moves() > 0);
+
+    lifecycle::Probe<ThrowingMove> throwing;
+    std::vector<ThrowingMove> b;
+    for (int i = 0; i < 100; i++)
+        b.emplace_back();
+    assert(throwing.delta().copies() > 0 && throwing.delta().moves() == 0);
+}
+
+static void test_allocations() {
+    lifecycle::Probe<Buffer> probe;
+    {
+        Buffer a(10);
+        Buffer b(std::move(a));
+        Buffer c(6);
+        assert(probe.delta().allocs() == 2 && probe.delta().bytes() == 16);
+        assert(probe.delta().n[lifecycle::FREES] == 0);
+    }
+    assert(probe.delta().n[lifecycle::FREES] == 2 && probe.delta().live() == 0);
+}
+
+static void test_threads() {
+    lifecycle::Counts before = lifecycle::totals<Plain>();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            lifecycle::Probe<Plain> probe;
+            Plain a;
+            for (int i = 0; i < 1000; i++) {
+                Plain b(a);
+                (void)b;
+            }
+            assert(probe.delta().copies() == 1000);   // only this thread's
+        });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    lifecycle::Counts d = lifecycle::totals<Plain>() - before;
+    assert(d.copies() == 4000 && d.live() == 0);
+}
+
+// not static, so that -rdynamic exports it and dladdr finds it; the copies go through Plain's own copy constructor
+// (a function of its own without optimization) and through Holder's defaulted one
+struct Holder {
+    Plain p;
+};
+
+__attribute__((noinline)) void copy_three(const Plain& a) {
+    take(a);
+    Holder h{a};
+    Holder g(h);
+    (void)g;
+}
+
+static void test_copy_sites() {
+    lifecycle::trace_copies<Plain>();
+    Plain a;
+    copy_three(a);
+    lifecycle::trace_copies<Plain>(false);
+    take(a);
+    auto& sites = lifecycle::detail::type_info<Plain>().copy_sites;
+    uint64_t traced = 0;
+    for (auto& [site, n] : sites) {
+        Dl_info dl;
+        assert(dladdr(site, &dl) && dl.dli_saddr == reinterpret_cast<void*>(&copy_three));
+        traced += n;
+    }
+    assert(traced == 3);
+
+    assert(lifecycle::detail::is_copy_member("Plain::Plain(Plain const&)"));
+    assert(lifecycle::detail::is_copy_member("ns::Pair<int, ns::X>::operator=(ns::Pair<int, ns::X> const&)"));
+    assert(lifecycle::detail::is_copy_member("ns::Pair<int, ns::X>::Pair(ns::Pair<int, ns::X> const&)"));
+    assert(!lifecycle::detail::is_copy_member("Plain::Plain(Plain&&)"));
+    assert(!lifecycle::detail::is_copy_member("take(Plain)"));
+}
+
+int main() {
+    test_special_members();
+    test_move_sem_patterns();
+    test_vector_growth();
+    test_allocations();
+    test_threads();
+    test_copy_sites();
+    std::cout << "ok\n";
+    return 0;
+}
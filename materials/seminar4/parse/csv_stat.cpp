@@ -0,0 +1,67 @@
+// Count, sum, min and max of one numeric column of a CSV-like file of any size: the file is mapped (parse::MappedFile)
+// and parsed in place; pages already parsed are dropped, so the resident size stays small for any file size.
+//   g++ -O2 -std=c++17 csv_stat.cpp -o csv_stat
+//   ./csv_stat file.csv column [delimiter = ,]
+//   ./csv_stat --generate MiB > file.csv        (rows like those of parse_bench.cpp; column 2 is the price)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include "parse.hpp"
+
+static int generate(long mib) {
+    std::mt19937 rng(1);
+    auto below = [&](unsigned n) { return unsigned(rng() % n); };
+    long bytes = 0;
+    for (long id = 0; bytes < (mib << 20); id++)
+        bytes += printf("%ld,item_%u,%u.%02u,%u,%u\n", id, below(100000), below(10000), below(100), below(100),
+                        1600000000 + below(100000000));
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--generate") == 0)
+        return generate(atol(argv[2]));
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s file column [delimiter]\n       %s --generate MiB\n", argv[0], argv[0]);
+        return 2;
+    }
+    long column = atol(argv[2]);
+    char delim = argc > 3 ? argv[3][0] : ',';
+
+    auto t0 = std::chrono::steady_clock::now();
+    parse::MappedFile file(argv[1]);
+    long rows = 0, numbers = 0;
+    double sum = 0, lo = std::numeric_limits<double>::infinity(), hi = -lo;
+    const char* dropped = file.view().data();
+    for (std::string_view line : parse::lines(file.view())) {
+        if (line.data() - dropped > (64 << 20)) {   // keep at most 64 MiB of the file resident
+            file.drop_before(line.data());
+            dropped = line.data();
+        }
+        rows++;
+        long i = 0;
+        std::string_view field;
+        for (std::string_view f : parse::split(line, delim)) {
+            if (i++ == column) {
+                field = f;
+                break;
+            }
+        }
+        double v;
+        if (i > column && parse::parse_number(parse::trim(field), v)) {
+            numbers++;
+            sum += v;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("rows %ld, numbers in column %ld: %ld, sum %.2f, min %g, max %g\n", rows, column, numbers, sum, lo, hi);
+    fprintf(stderr, "%.1f MiB in %.2f s, %.2f GB/s\n", file.size() / 1048576.0, s, file.size() / s / 1e9);
+    return 0;
+}
@@ -0,0 +1,270 @@
+// Parsing without copies: splitters and tokenizers that yield std::string_view into the input, numbers with
+// std::from_chars, and a read-only file mapping to parse files of any size. See readme.md.
+//
+// Nothing here allocates per token: a view is a pointer and a length into the caller's buffer, which must outlive
+// the views (a String(const char*) per field of ../move_sem_1.cpp is one allocation and one copy each).
+//
+//     for (std::string_view line : parse::lines(text))
+//         for (std::string_view field : parse::split(line, ','))
+//             if (auto v = parse::to_number<double>(field)) sum += *v;
+#ifndef PARSE_HPP
+#define PARSE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace parse {
+
+/** Single-pass range over the pieces of a view; Next(rest, piece) cuts the next piece off rest or returns false. */
+template <class Next>
+class Pieces {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        iterator(std::string_view rest, Next next) : rest_(rest), next_(next) { ++*this; }
+
+        const std::string_view& operator*() const { return piece_; }
+        const std::string_view* operator->() const { return &piece_; }
+        iterator& operator++() {
+            done_ = !next_(rest_, piece_);
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // only the end compares: the iterators of one range are never compared with each other
+        bool operator==(const iterator& o) const { return done_ == o.done_; }
+        bool operator!=(const iterator& o) const { return done_ != o.done_; }
+
+    private:
+        std::string_view rest_, piece_;
+        Next next_{};
+        bool done_ = true;
+    };
+
+    Pieces(std::string_view s, Next next) : s_(s), next_(next) {}
+    iterator begin() const { return iterator(s_, next_); }
+    iterator end() const { return iterator(); }
+
+private:
+    std::string_view s_;
+    Next next_;
+};
+
+namespace detail {
+
+// the pieces between single delimiters: "a,,b," is "a", "", "b", ""
+struct SplitNext {
+    char delim = ',';
+    bool more = true;   // a delimiter at the end leaves one more (empty) piece
+
+    bool operator()(std::string_view& rest, std::string_view& piece) {
+        if (!more)
+            return false;
+        const char* p = static_cast<const char*>(memchr(rest.data(), delim, rest.size()));
+        if (!p) {
+            piece = rest;
+            more = false;
+            return true;
+        }
+        size_t n = p - rest.data();
+        piece = rest.substr(0, n);
+        rest.remove_prefix(n + 1);
+        return true;
+    }
+};
+
+// lines without their "\n" or "\r\n"; no empty last line after a final newline
+struct LineNext {
+    bool operator()(std::string_view& rest, std::string_view& line) {
+        if (rest.empty())
+            return false;
+        const char* p = static_cast<const char*>(memchr(rest.data(), '\n', rest.size()));
+        size_t n = p ? p - rest.data() : rest.size();
+        line = rest.substr(0, n);
+        rest.remove_prefix(p ? n + 1 : n);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        return true;
+    }
+};
+
+// runs of bytes that are not in the set; empty tokens are skipped
+struct TokenNext {
+    const bool* is_sep;   // 256 entries, owned by the Tokenizer
+
+    bool operator()(std::string_view& rest, std::string_view& token) {
+        size_t i = 0, n = rest.size();
+        while (i < n && is_sep[(unsigned char)rest[i]])
+            i++;
+        if (i == n)
+            return false;
+        size_t start = i;
+        while (i < n && !is_sep[(unsigned char)rest[i]])
+            i++;
+        token = rest.substr(start, i - start);
+        rest.remove_prefix(i);
+        return true;
+    }
+};
+
+} // namespace detail
+
+/** The fields between every `delim` (a CSV line without quoting): "a,,b" gives "a", "", "b". */
+inline Pieces<detail::SplitNext> split(std::string_view s, char delim) {
+    return {s, detail::SplitNext{delim}};
+}
+
+/** The lines of s without the terminating "\n" or "\r\n". */
+inline Pieces<detail::LineNext> lines(std::string_view s) {
+    return {s, detail::LineNext{}};
+}
+
+/** Splits on any byte of a set of separators, skipping empty tokens (whitespace-separated words by default). */
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view separators = " \t\r\n\f\v") {
+        for (char c : separators)
+            is_sep_[(unsigned char)c] = true;
+    }
+
+    /** The tokens of s; the range refers to this Tokenizer, which must outlive it. */
+    Pieces<detail::TokenNext> operator()(std::string_view s) const { return {s, detail::TokenNext{is_sep_}}; }
+
+private:
+    bool is_sep_[256] = {};
+};
+
+/** The tokens of s separated by whitespace. */
+inline Pieces<detail::TokenNext> words(std::string_view s) {
+    static const Tokenizer whitespace;
+    return whitespace(s);
+}
+
+/** Cuts the first field before `delim` off s (all of s if there is none): a pull-style split. */
+inline std::string_view next_field(std::string_view& s, char delim) {
+    const char* p = static_cast<const char*>(memchr(s.data(), delim, s.size()));
+    size_t n = p ? p - s.data() : s.size();
+    std::string_view field = s.substr(0, n);
+    s.remove_prefix(p ? n + 1 : n);
+    return field;
+}
+
+/** s without leading and trailing spaces and tabs. */
+inline std::string_view trim(std::string_view s) {
+    size_t b = 0, e = s.size();
+    while (b < e && (s[b] == ' ' || s[b] == '\t'))
+        b++;
+    while (e > b && (s[e - 1] == ' ' || s[e - 1] == '\t'))
+        e--;
+    return s.substr(b, e - b);
+}
+
+/**
+ * Parses all of s as a number of type T (integer or floating point) with std::from_chars: no locale, no
+ * allocation, no leading whitespace or '+'. Returns false, leaving out unchanged, if s is empty, has trailing
+ * characters or the value does not fit.
+ */
+template <class T>
+bool parse_number(std::string_view s, T& out) {
+    T v{};
+    std::from_chars_result r = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (r.ec != std::errc() || r.ptr != s.data() + s.size() || s.empty())
+        return false;
+    out = v;
+    return true;
+}
+
+/** parse_number as an optional. */
+template <class T>
+std::optional<T> to_number(std::string_view s) {
+    T v{};
+    if (parse_number(s, v))
+        return v;
+    return std::nullopt;
+}
+
+/** A file mapped read-only: its bytes as one view, paged in by the kernel as they are read. */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "parse::MappedFile: " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int e = errno;
+            close(fd);
+            throw std::system_error(e, std::generic_category(), "parse::MappedFile: " + path);
+        }
+        size_ = st.st_size;
+        if (size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                int e = errno;
+                close(fd);
+                throw std::system_error(e, std::generic_category(), "parse::MappedFile: " + path);
+            }
+            data_ = static_cast<const char*>(p);
+            madvise(p, size_, MADV_SEQUENTIAL);   // larger read-ahead, pages behind the reader are dropped first
+        }
+        close(fd);   // the mapping keeps the file
+    }
+
+    ~MappedFile() {
+        if (data_)
+            munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(MappedFile&& o) noexcept
+        : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)), dropped_(std::exchange(o.dropped_, 0)) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const { return {data_ ? data_ : "", size_}; }
+    size_t size() const { return size_; }
+
+    /**
+     * Unmaps the pages before p from the process (they are read again from the file if touched), so that one pass
+     * over a file larger than memory keeps a bounded resident size. Views before p stay valid.
+     */
+    void drop_before(const char* p) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t n = (p - data_) / page * page;
+        if (n > dropped_) {
+            madvise(const_cast<char*>(data_) + dropped_, n - dropped_, MADV_DONTNEED);
+            dropped_ = n;
+        }
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t dropped_ = 0;   // bytes from the start released by drop_before
+};
+
+} // namespace parse
+
+#endif // PARSE_HPP
@@ -0,0 +1,166 @@
+// CSV-like parsing of 64 MiB of rows "id,name,price,qty,timestamp": iostreams with std::string fields and stod,
+// fields copied into std::string, and parse.hpp views with from_chars (runner of ../../seminar10/bench).
+//   g++ -O2 -std=c++17 parse_bench.cpp -o parse_bench && ./parse_bench
+// Throughput is in input bytes/s; after the table, heap allocations per row of each variant.
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "parse.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+static size_t g_allocs = 0;
+
+void* operator new(size_t n) {
+    g_allocs++;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static const std::string& input() {
+    static const std::string s = [] {
+        std::mt19937 rng(1);
+        std::string s;
+        auto below = [&](unsigned n) { return unsigned(rng() % n); };
+        char row[128];
+        for (long id = 0; s.size() < (64 << 20); id++) {
+            int n = snprintf(row, sizeof(row), "%ld,item_%u,%u.%02u,%u,%u\n", id, below(100000), below(10000),
+                             below(100), below(100), 1600000000 + below(100000000));
+            s.append(row, n);
+        }
+        return s;
+    }();
+    return s;
+}
+
+// the total of price * qty, the same for every variant
+struct Total {
+    double value = 0;
+    long rows = 0;
+};
+
+static Total parse_iostream(const std::string& text) {
+    Total t;
+    std::istringstream in(text);
+    std::string line, field;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        double price = 0;
+        long qty = 0;
+        for (int i = 0; std::getline(fields, field, ','); i++) {
+            if (i == 2)
+                price = std::stod(field);
+            else if (i == 3)
+                qty = std::stol(field);
+        }
+        t.value += price * qty;
+        t.rows++;
+    }
+    return t;
+}
+
+// the usual hand-written split: a vector of std::string per row
+static Total parse_strings(const std::string& text) {
+    Total t;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = text.size();
+        std::vector<std::string> fields;
+        for (size_t b = pos; b <= eol;) {
+            size_t e = text.find(',', b);
+            if (e == std::string::npos || e > eol)
+                e = eol;
+            fields.push_back(text.substr(b, e - b));
+            b = e + 1;
+        }
+        t.value += strtod(fields[2].c_str(), nullptr) * strtol(fields[3].c_str(), nullptr, 10);
+        t.rows++;
+        pos = eol + 1;
+    }
+    return t;
+}
+
+static Total parse_views(std::string_view text) {
+    Total t;
+    for (std::string_view line : parse::lines(text)) {
+        double price = 0;
+        long qty = 0;
+        int i = 0;
+        for (std::string_view field : parse::split(line, ',')) {
+            if (i == 2)
+                parse::parse_number(field, price);
+            else if (i == 3)
+                parse::parse_number(field, qty);
+            i++;
+        }
+        t.value += price * qty;
+        t.rows++;
+    }
+    return t;
+}
+
+// known column order: cut the fields off one by one and stop after the last one needed
+static Total parse_views_pull(std::string_view text) {
+    Total t;
+    for (std::string_view line : parse::lines(text)) {
+        parse::next_field(line, ',');
+        parse::next_field(line, ',');
+        double price = 0;
+        long qty = 0;
+        parse::parse_number(parse::next_field(line, ','), price);
+        parse::parse_number(parse::next_field(line, ','), qty);
+        t.value += price * qty;
+        t.rows++;
+    }
+    return t;
+}
+
+template <Total (*Parse)(const std::string&)>
+static void bm_owning(bench::State& st) {
+    const std::string& text = input();
+    while (st.keep_running())
+        bench::do_not_optimize(Parse(text).value);
+    st.set_items_per_iteration(text.size());
+}
+
+template <Total (*Parse)(std::string_view)>
+static void bm_views(bench::State& st) {
+    const std::string& text = input();
+    while (st.keep_running())
+        bench::do_not_optimize(Parse(text).value);
+    st.set_items_per_iteration(text.size());
+}
+
+BENCH(bm_owning<parse_iostream>);
+BENCH(bm_owning<parse_strings>);
+BENCH(bm_views<parse_views>);
+BENCH(bm_views<parse_views_pull>);
+
+int main(int argc, char** argv) {
+    int r = bench::run_all(argc, argv);
+    const std::string& text = input();
+    struct Variant {
+        const char* name;
+        Total (*parse)(const std::string&);
+    } variants[] = {
+        {"iostream", parse_iostream},
+        {"strings", parse_strings},
+        {"views", [](const std::string& s) { return parse_views(s); }},
+        {"views_pull", [](const std::string& s) { return parse_views_pull(s); }},
+    };
+    printf("\n%-12s %12s %14s %18s\n", "variant", "rows", "allocs/row", "sum(price*qty)");
+    for (const Variant& v : variants) {
+        size_t before = g_allocs;
+        Total t = v.parse(text);
+        printf("%-12s %12ld %14.2f %18.2f\n", v.name, t.rows, double(g_allocs - before) / t.rows, t.value);
+    }
+    return r;
+}
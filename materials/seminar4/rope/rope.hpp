@@ -0,0 +1,345 @@
+// Rope: an immutable balanced tree of shared string chunks, see readme.md.
+//
+// Copies share the whole tree (one reference count increment), concatenation, substring, insert and erase
+// build O(log n) new nodes and share the rest, so building a large message by appends or inserts is not quadratic.
+// Leaves are views (offset, length) into reference-counted chunks: substrings never copy characters.
+// Appends to an unshared rope fill the last chunk in place (up to CHUNK bytes), like std::string's capacity.
+// The tree is kept AVL-balanced by height; joining trees of different heights descends the spine of the taller one.
+#ifndef ROPE_HPP
+#define ROPE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace rope {
+
+class Rope {
+public:
+    static constexpr size_t CHUNK = 4096;     // longer inputs are cut into chunks of this size
+    static constexpr size_t MERGE = 256;      // neighbouring leaves shorter than this together are merged
+    static constexpr int MAX_HEIGHT = 96;     // AVL height bound for ~2^64 leaves, sizes the iterator stack
+
+    Rope() = default;
+    explicit Rope(const char* s) : Rope(std::string_view(s)) {}
+    explicit Rope(std::string_view s) : root_(from_chars(s.data(), s.size())) {}
+
+    size_t size() const noexcept { return root_ ? root_->size : 0; }
+    bool empty() const noexcept { return size() == 0; }
+    int height() const noexcept { return height(root_); }
+
+    /** O(log n). */
+    char operator[](size_t i) const {
+        const Node* n = root_.get();
+        while (!n->leaf()) {
+            size_t ls = n->left->size;
+            if (i < ls) {
+                n = n->left.get();
+            } else {
+                i -= ls;
+                n = n->right.get();
+            }
+        }
+        return n->chunk->data()[n->offset + i];
+    }
+
+    char at(size_t i) const {
+        if (i >= size())
+            throw std::out_of_range("Rope::at");
+        return (*this)[i];
+    }
+
+    friend Rope operator+(const Rope& a, const Rope& b) { return Rope(join(a.root_, b.root_)); }
+
+    Rope& operator+=(const Rope& other) {
+        root_ = join(root_, other.root_);
+        return *this;
+    }
+
+    Rope& operator+=(std::string_view s) {
+        if (!append_in_place(s))
+            root_ = join(root_, from_chars(s.data(), s.size()));
+        return *this;
+    }
+
+    Rope& append(const char* s, size_t n) { return *this += std::string_view(s, n); }
+
+    /** Characters [pos, pos + len) clamped to the size, sharing the chunks. */
+    Rope substr(size_t pos, size_t len = std::string::npos) const {
+        if (pos > size())
+            throw std::out_of_range("Rope::substr");
+        len = std::min(len, size() - pos);
+        Ptr right = split(root_, pos).second;
+        return Rope(split(right, len).first);
+    }
+
+    Rope& insert(size_t pos, const Rope& r) {
+        if (pos > size())
+            throw std::out_of_range("Rope::insert");
+        auto parts = split(root_, pos);
+        root_ = join(join(parts.first, r.root_), parts.second);
+        return *this;
+    }
+
+    Rope& insert(size_t pos, std::string_view s) { return insert(pos, Rope(s)); }
+
+    Rope& erase(size_t pos, size_t len = std::string::npos) {
+        if (pos > size())
+            throw std::out_of_range("Rope::erase");
+        len = std::min(len, size() - pos);
+        auto parts = split(root_, pos);
+        root_ = join(parts.first, split(parts.second, len).second);
+        return *this;
+    }
+
+    /** Calls fn(const char*, size_t) for every leaf in order: the fastest way to read a rope. */
+    template <class Fn>
+    void for_each_chunk(Fn&& fn) const {
+        if (root_)
+            visit(root_.get(), fn);
+    }
+
+    /** Flattens into out, which must have room for size() characters. */
+    void copy_to(char* out) const {
+        for_each_chunk([&](const char* p, size_t n) {
+            memcpy(out, p, n);
+            out += n;
+        });
+    }
+
+    std::string str() const {
+        std::string s(size(), '\0');
+        copy_to(&s[0]);
+        return s;
+    }
+
+    /** Replaces the tree with a single contiguous leaf (when it is read as a whole many times). */
+    void flatten() {
+        if (root_ && !root_->leaf())
+            root_ = make_leaf(std::make_shared<std::string>(str()), 0, size());
+    }
+
+    friend bool operator==(const Rope& a, const Rope& b) {
+        if (a.size() != b.size())
+            return false;
+        const_iterator i = a.begin(), j = b.begin();
+        for (; i != a.end(); ++i, ++j)
+            if (*i != *j)
+                return false;
+        return true;
+    }
+
+    struct Node;
+    using Ptr = std::shared_ptr<const Node>;
+
+    struct Node {
+        Ptr left, right;                             // both empty in a leaf
+        std::shared_ptr<const std::string> chunk;    // leaf only
+        size_t offset = 0;                           // leaf: view into the chunk
+        size_t size = 0;
+        int height = 0;                              // leaf = 1
+        bool leaf() const { return !left; }
+    };
+
+    /** Forward iterator: a stack of the nodes on the way to the current leaf and a position in it. */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return cur_[0]; }
+
+        const_iterator& operator++() {
+            if (++cur_ == end_)
+                next_leaf();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator t = *this;
+            ++*this;
+            return t;
+        }
+
+        bool operator==(const const_iterator& o) const { return cur_ == o.cur_; }
+        bool operator!=(const const_iterator& o) const { return cur_ != o.cur_; }
+
+    private:
+        friend class Rope;
+
+        explicit const_iterator(const Node* root) {
+            if (root)
+                descend(root);
+        }
+
+        void descend(const Node* n) {
+            while (!n->leaf()) {
+                stack_[depth_++] = n->right.get();   // visited after the left subtree
+                n = n->left.get();
+            }
+            cur_ = n->chunk->data() + n->offset;
+            end_ = cur_ + n->size;
+        }
+
+        void next_leaf() {
+            if (depth_ == 0) {
+                cur_ = end_ = nullptr;
+                return;
+            }
+            descend(stack_[--depth_]);
+        }
+
+        const char* cur_ = nullptr;   // nullptr at the end
+        const char* end_ = nullptr;
+        const Node* stack_[MAX_HEIGHT];
+        int depth_ = 0;
+    };
+
+    const_iterator begin() const { return const_iterator(root_.get()); }
+    const_iterator end() const { return const_iterator(); }
+
+private:
+    explicit Rope(Ptr root) : root_(std::move(root)) {}
+
+    static int height(const Ptr& n) { return n ? n->height : 0; }
+
+    static Ptr make_leaf(std::shared_ptr<const std::string> chunk, size_t offset, size_t len) {
+        auto n = std::make_shared<Node>();
+        n->chunk = std::move(chunk);
+        n->offset = offset;
+        n->size = len;
+        n->height = 1;
+        return n;
+    }
+
+    static Ptr make_node(Ptr l, Ptr r) {
+        auto n = std::make_shared<Node>();
+        n->size = l->size + r->size;
+        n->height = 1 + std::max(l->height, r->height);
+        n->left = std::move(l);
+        n->right = std::move(r);
+        return n;
+    }
+
+    static Ptr from_chars(const char* s, size_t n) {
+        if (n == 0)
+            return nullptr;
+        if (n <= CHUNK)
+            return make_leaf(std::make_shared<std::string>(s, n), 0, n);
+        size_t half = (n / 2 + CHUNK - 1) / CHUNK * CHUNK;   // chunk-aligned split keeps full chunks
+        return make_node(from_chars(s, half), from_chars(s + half, n - half));
+    }
+
+    // one rotation step of the AVL rebalancing on the node (l, r) with |h(l) - h(r)| <= 2
+    static Ptr balance(Ptr l, Ptr r) {
+        int hl = height(l), hr = height(r);
+        if (hl > hr + 1) {
+            if (height(l->left) >= height(l->right))
+                return make_node(l->left, make_node(l->right, std::move(r)));
+            return make_node(make_node(l->left, l->right->left), make_node(l->right->right, std::move(r)));
+        }
+        if (hr > hl + 1) {
+            if (height(r->right) >= height(r->left))
+                return make_node(make_node(std::move(l), r->left), r->right);
+            return make_node(make_node(std::move(l), r->left->left), make_node(r->left->right, r->right));
+        }
+        return make_node(std::move(l), std::move(r));
+    }
+
+    // concatenation in O(|h(a) - h(b)| + 1) new nodes
+    static Ptr join(const Ptr& a, const Ptr& b) {
+        if (!a || a->size == 0)
+            return b;
+        if (!b || b->size == 0)
+            return a;
+        if (a->leaf() && b->leaf() && a->size + b->size <= MERGE) {
+            auto chunk = std::make_shared<std::string>(a->chunk->data() + a->offset, a->size);
+            chunk->append(b->chunk->data() + b->offset, b->size);
+            size_t n = chunk->size();
+            return make_leaf(std::move(chunk), 0, n);
+        }
+        if (a->height > b->height + 1)
+            return balance(a->left, join(a->right, b));
+        if (b->height > a->height + 1)
+            return balance(join(a, b->left), b->right);
+        // small tails are merged too, so appending short pieces does not grow the tree by a leaf each time
+        if (!a->leaf() && b->leaf() && a->right->leaf() && a->right->size + b->size <= MERGE)
+            return balance(a->left, join(a->right, b));
+        return make_node(a, b);
+    }
+
+    // (first pos characters, the rest)
+    static std::pair<Ptr, Ptr> split(const Ptr& n, size_t pos) {
+        if (!n)
+            return {nullptr, nullptr};
+        if (pos == 0)
+            return {nullptr, n};
+        if (pos >= n->size)
+            return {n, nullptr};
+        if (n->leaf())
+            return {make_leaf(n->chunk, n->offset, pos), make_leaf(n->chunk, n->offset + pos, n->size - pos)};
+        size_t ls = n->left->size;
+        if (pos <= ls) {
+            auto p = split(n->left, pos);
+            return {p.first, join(p.second, n->right)};
+        }
+        auto p = split(n->right, pos - ls);
+        return {join(n->left, p.first), p.second};
+    }
+
+    // Appending to a rope that nobody shares: the right spine and the last chunk belong to this object only,
+    // so the characters go into the spare capacity of the last chunk without new nodes.
+    bool append_in_place(std::string_view s) {
+        if (!root_ || root_.use_count() != 1)
+            return false;
+        Node* path[MAX_HEIGHT];
+        int depth = 0;
+        Node* n = const_cast<Node*>(root_.get());   // nodes and chunks are never created const
+        path[depth++] = n;
+        while (!n->leaf()) {
+            if (n->right.use_count() != 1)
+                return false;
+            n = const_cast<Node*>(n->right.get());
+            path[depth++] = n;
+        }
+        if (n->chunk.use_count() != 1 || n->offset + n->size != n->chunk->size() || n->size + s.size() > CHUNK)
+            return false;
+        // use_count() is a relaxed load: the fence orders the writes below after the reads another thread made
+        // through a copy it has just destroyed (its decrement is a release)
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto& chunk = const_cast<std::string&>(*n->chunk);
+        if (chunk.capacity() < CHUNK)
+            chunk.reserve(CHUNK);
+        chunk.append(s.data(), s.size());
+        for (int i = 0; i < depth; i++)
+            path[i]->size += s.size();
+        return true;
+    }
+
+    template <class Fn>
+    static void visit(const Node* n, Fn& fn) {
+        while (!n->leaf()) {
+            visit(n->left.get(), fn);
+            n = n->right.get();
+        }
+        fn(n->chunk->data() + n->offset, n->size);
+    }
+
+    Ptr root_;
+};
+
+} // namespace rope
+
+#endif // ROPE_HPP
@@ -0,0 +1,131 @@
+// rope::Rope against std::string: building a message, inserts in the middle, copies and reading.
+//   g++ -O2 -std=c++17 rope_bench.cpp -o rope_bench && ./rope_bench [--filter=insert]
+#include <random>
+#include <string>
+#include "rope.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+static const std::string PIECE(64, 'x');
+
+// msg += piece until arg bytes: amortized O(1) for both
+template <class S>
+static void bm_append(bench::State& st) {
+    while (st.keep_running()) {
+        S msg;
+        for (long n = 0; n < st.arg(); n += PIECE.size())
+            msg += PIECE;
+        bench::do_not_optimize(msg);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+// msg = msg + piece, what the seminar4 String allows: a copy of msg per step, quadratic for std::string
+static void bm_concat_copy_std(bench::State& st) {
+    while (st.keep_running()) {
+        std::string msg;
+        for (long n = 0; n < st.arg(); n += PIECE.size())
+            msg = msg + PIECE;
+        bench::do_not_optimize(msg);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static void bm_concat_copy_rope(bench::State& st) {
+    rope::Rope piece(PIECE);
+    while (st.keep_running()) {
+        rope::Rope msg;
+        for (long n = 0; n < st.arg(); n += PIECE.size())
+            msg = msg + piece;
+        bench::do_not_optimize(msg);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+// 1000 inserts of a piece at random positions into a text of arg bytes
+template <class S>
+static void bm_insert(bench::State& st) {
+    S base(std::string(st.arg(), 'a'));
+    std::mt19937 rng(1);
+    while (st.keep_running()) {
+        st.pause_timing();
+        S text = base;
+        st.resume_timing();
+        for (int i = 0; i < 1000; i++)
+            text.insert(rng() % (text.size() + 1), PIECE);
+        bench::do_not_optimize(text);
+    }
+    st.set_items_per_iteration(1000);
+}
+
+template <class S>
+static void bm_copy(bench::State& st) {
+    S text(std::string(st.arg(), 'a'));
+    while (st.keep_running()) {
+        S copy = text;
+        bench::do_not_optimize(copy);
+    }
+}
+
+// a rope built from 64-byte appends, read character by character
+static void bm_iterate_std(bench::State& st) {
+    std::string text(st.arg(), 'a');
+    while (st.keep_running()) {
+        unsigned sum = 0;
+        for (char c : text)
+            sum += c;
+        bench::do_not_optimize(sum);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static rope::Rope appended(long n) {
+    rope::Rope r;
+    for (long i = 0; i < n; i += PIECE.size())
+        r += PIECE;
+    return r;
+}
+
+static void bm_iterate_rope(bench::State& st) {
+    rope::Rope text = appended(st.arg());
+    while (st.keep_running()) {
+        unsigned sum = 0;
+        for (char c : text)
+            sum += c;
+        bench::do_not_optimize(sum);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static void bm_iterate_rope_chunks(bench::State& st) {
+    rope::Rope text = appended(st.arg());
+    while (st.keep_running()) {
+        unsigned sum = 0;
+        text.for_each_chunk([&](const char* p, size_t n) {
+            for (size_t i = 0; i < n; i++)
+                sum += p[i];
+        });
+        bench::do_not_optimize(sum);
+    }
+    st.set_items_per_iteration(st.arg());
+}
+
+static void bm_flatten_rope(bench::State& st) {
+    rope::Rope text = appended(st.arg());
+    while (st.keep_running())
+        bench::do_not_optimize(text.str());
+    st.set_items_per_iteration(st.arg());
+}
+
+BENCH(bm_append<std::string>, 1 << 20, 16 << 20);
+BENCH(bm_append<rope::Rope>, 1 << 20, 16 << 20);
+BENCH(bm_concat_copy_std, 1 << 16, 1 << 20);
+BENCH(bm_concat_copy_rope, 1 << 16, 1 << 20);
+BENCH(bm_insert<std::string>, 1 << 20, 16 << 20);
+BENCH(bm_insert<rope::Rope>, 1 << 20, 16 << 20);
+BENCH(bm_copy<std::string>, 1 << 20, 16 << 20);
+BENCH(bm_copy<rope::Rope>, 1 << 20, 16 << 20);
+BENCH(bm_iterate_std, 1 << 20, 16 << 20);
+BENCH(bm_iterate_rope, 1 << 20, 16 << 20);
+BENCH(bm_iterate_rope_chunks, 1 << 20, 16 << 20);
+BENCH(bm_flatten_rope, 1 << 20, 16 << 20);
+BENCH_MAIN();
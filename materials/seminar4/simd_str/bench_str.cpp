@@ -0,0 +1,131 @@
+// str_kernels.hpp implementations against libc / std on 16 B .. 1 MiB inputs (runner of ../../seminar10/bench).
+//   g++ -O2 -std=c++17 bench_str.cpp -o bench_str && ./bench_str [--filter=find_byte]
+// Throughput is in bytes/s. Searches scan the whole input (the match is at the end).
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include "str_kernels.hpp"
+#include "../../seminar10/bench/bench.hpp"
+
+enum Impl { AVX2, SSE42, SCALAR, LIBC };
+
+static const strk::Kernels& kernels(Impl i) { return strk::ALL[i]; }
+
+// lower case letters and spaces, with Cyrillic (2-byte UTF-8) words mixed in for the validator
+static std::string text(size_t n) {
+    std::mt19937 rng(1);
+    std::string s;
+    while (s.size() < n) {
+        if (rng() % 8 == 0)
+            s += "\xD1\x82\xD0\xB5\xD0\xBA\xD1\x81\xD1\x82 ";   // "текст "
+        else
+            s += char('a' + rng() % 26), s += rng() % 6 ? "" : " ";
+    }
+    s.resize(n);
+    return s;
+}
+
+template <Impl I>
+static void bm_find_byte(bench::State& st) {
+    std::string s = text(st.arg());
+    s.back() = '#';
+    while (st.keep_running()) {
+        size_t r = I == LIBC ? (const char*)memchr(s.data(), '#', s.size()) - s.data()
+                             : kernels(I).find_byte(s.data(), s.size(), '#');
+        bench::do_not_optimize(r);
+    }
+    st.set_items_per_iteration(s.size());
+}
+
+template <Impl I>
+static void bm_find(bench::State& st) {
+    std::string s = text(st.arg());
+    const std::string needle = "needle";   // first and last letters are frequent in the text
+    std::copy(needle.begin(), needle.end(), s.end() - std::min(s.size(), needle.size()));
+    while (st.keep_running()) {
+        size_t r = I == LIBC ? std::string_view(s).find(needle)
+                             : kernels(I).find(s.data(), s.size(), needle.data(), needle.size());
+        bench::do_not_optimize(r);
+    }
+    st.set_items_per_iteration(s.size());
+}
+
+static void bm_find_memmem(bench::State& st) {
+    std::string s = text(st.arg());
+    const std::string needle = "needle";
+    std::copy(needle.begin(), needle.end(), s.end() - std::min(s.size(), needle.size()));
+    while (st.keep_running())
+        bench::do_not_optimize(memmem(s.data(), s.size(), needle.data(), needle.size()));
+    st.set_items_per_iteration(s.size());
+}
+
+template <Impl I>
+static void bm_equal(bench::State& st) {
+    std::string a = text(st.arg()), b = a;
+    while (st.keep_running()) {
+        bool r = I == LIBC ? memcmp(a.data(), b.data(), a.size()) == 0 : kernels(I).equal(a.data(), b.data(), a.size());
+        bench::do_not_optimize(r);
+    }
+    st.set_items_per_iteration(a.size());
+}
+
+template <Impl I>
+static void bm_to_lower(bench::State& st) {
+    std::string a = text(st.arg()), out(a.size(), ' ');
+    std::transform(a.begin(), a.end(), a.begin(), [](char c) { return c ^ 0x20 * (c >= 'a' && c <= 'z' && c & 1); });
+    while (st.keep_running()) {
+        if (I == LIBC)
+            std::transform(a.begin(), a.end(), out.begin(), [](unsigned char c) { return (char)tolower(c); });
+        else
+            kernels(I).to_lower(&out[0], a.data(), a.size());
+        bench::do_not_optimize(out);
+    }
+    st.set_items_per_iteration(a.size());
+}
+
+template <Impl I>
+static void bm_validate_utf8(bench::State& st) {
+    std::string s = text(st.arg());
+    while (s.size() && (s.back() & 0x80))   // do not end in the middle of a character
+        s.pop_back();
+    while (st.keep_running())
+        bench::do_not_optimize(kernels(I).validate_utf8(s.data(), s.size()));
+    st.set_items_per_iteration(s.size());
+}
+
+#define SIZES 16, 256, 4096, 65536, 1 << 20
+BENCH(bm_find_byte<AVX2>, SIZES);
+BENCH(bm_find_byte<SSE42>, SIZES);
+BENCH(bm_find_byte<SCALAR>, SIZES);
+BENCH(bm_find_byte<LIBC>, SIZES);
+BENCH(bm_find<AVX2>, SIZES);
+BENCH(bm_find<SSE42>, SIZES);
+BENCH(bm_find<SCALAR>, SIZES);
+BENCH(bm_find<LIBC>, SIZES);
+BENCH(bm_find_memmem, SIZES);
+BENCH(bm_equal<AVX2>, SIZES);
+BENCH(bm_equal<SSE42>, SIZES);
+BENCH(bm_equal<SCALAR>, SIZES);
+BENCH(bm_equal<LIBC>, SIZES);
+BENCH(bm_to_lower<AVX2>, SIZES);
+BENCH(bm_to_lower<SSE42>, SIZES);
+BENCH(bm_to_lower<SCALAR>, SIZES);
+BENCH(bm_to_lower<LIBC>, SIZES);
+BENCH(bm_validate_utf8<AVX2>, SIZES);
+BENCH(bm_validate_utf8<SSE42>, SIZES);
+BENCH(bm_validate_utf8<SCALAR>, SIZES);
+
+int main(int argc, char** argv) {
+    // the CPU may lack some sets: drop their benchmarks
+    auto& r = bench::registry();
+    r.erase(std::remove_if(r.begin(), r.end(),
+                           [](const bench::Benchmark& b) {
+                               return (strstr(b.name.c_str(), "<AVX2>") && !strk::use("avx2")) ||
+                                      (strstr(b.name.c_str(), "<SSE42>") && !strk::use("sse42"));
+                           }),
+            r.end());
+    return bench::run_all(argc, argv);
+}
@@ -0,0 +1,227 @@
+// SIMD string kernels with runtime dispatch: find a byte, find a substring, equality, ASCII lower case,
+// UTF-8 validation. See readme.md.
+//
+// Every kernel exists three times: scalar, SSE4.2 (16 bytes) and AVX2 (32 bytes). The vector versions are one
+// template text (str_kernels_impl.inc) compiled under `#pragma GCC target` for each set, so the program itself
+// needs no -march flag; the best set the CPU supports is chosen at the first call (__builtin_cpu_supports).
+#ifndef STR_KERNELS_HPP
+#define STR_KERNELS_HPP
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace strk {
+
+constexpr size_t npos = ~size_t(0);
+
+namespace scalar {
+
+inline size_t find_byte(const char* p, size_t n, char c) {
+    for (size_t i = 0; i < n; i++)
+        if (p[i] == c)
+            return i;
+    return npos;
+}
+
+inline size_t find(const char* h, size_t n, const char* nd, size_t m) {
+    if (m == 0)
+        return 0;
+    for (size_t i = 0; i + m <= n; i++)
+        if (h[i] == nd[0] && memcmp(h + i, nd, m) == 0)
+            return i;
+    return npos;
+}
+
+inline bool equal(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+inline void to_lower(char* dst, const char* src, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (src[i] >= 'A' && src[i] <= 'Z') ? src[i] | 0x20 : src[i];
+}
+
+// byte by byte, with the ranges of the Unicode standard (table 3-7)
+inline bool validate_utf8(const char* s, size_t n) {
+    const unsigned char* p = (const unsigned char*)s;
+    size_t i = 0;
+    while (i < n) {
+        unsigned c = p[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t len;
+        unsigned lo = 0x80, hi = 0xBF;   // range of the second byte
+        if (c >= 0xC2 && c <= 0xDF) {
+            len = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            len = 3;
+            if (c == 0xE0)
+                lo = 0xA0;
+            if (c == 0xED)
+                hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            len = 4;
+            if (c == 0xF0)
+                lo = 0x90;
+            if (c == 0xF4)
+                hi = 0x8F;
+        } else {
+            return false;
+        }
+        if (i + len > n || p[i + 1] < lo || p[i + 1] > hi)
+            return false;
+        for (size_t k = 2; k < len; k++)
+            if ((p[i + k] & 0xC0) != 0x80)
+                return false;
+        i += len;
+    }
+    return true;
+}
+
+} // namespace scalar
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+namespace sse42 {
+namespace narrow = scalar;
+struct Vec {
+    using T = __m128i;
+    static constexpr size_t W = 16;
+    static constexpr uint32_t FULL = 0xFFFF;
+    static T load(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void store(char* p, T v) { _mm_storeu_si128((__m128i*)p, v); }
+    static T set1(char c) { return _mm_set1_epi8(c); }
+    static T eq(T a, T b) { return _mm_cmpeq_epi8(a, b); }
+    static T gt(T a, T b) { return _mm_cmpgt_epi8(a, b); }
+    static T and_(T a, T b) { return _mm_and_si128(a, b); }
+    static T or_(T a, T b) { return _mm_or_si128(a, b); }
+    static T xor_(T a, T b) { return _mm_xor_si128(a, b); }
+    static T subs(T a, T b) { return _mm_subs_epu8(a, b); }
+    static uint32_t mask(T v) { return (uint32_t)_mm_movemask_epi8(v); }
+    static bool any(T v) { return !_mm_testz_si128(v, v); }
+    static T shr4(T v) { return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)); }
+    template <class... B>
+    static T lookup16(T idx, B... table) { return _mm_shuffle_epi8(_mm_setr_epi8(char(table)...), idx); }
+    template <int N>
+    static T prev(T in, T prev_in) { return _mm_alignr_epi8(in, prev_in, 16 - N); }
+    static T incomplete_limits() {
+        return _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                             char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+    }
+};
+#include "str_kernels_impl.inc"
+} // namespace sse42
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+namespace narrow = sse42;
+struct Vec {
+    using T = __m256i;
+    static constexpr size_t W = 32;
+    static constexpr uint32_t FULL = 0xFFFFFFFF;
+    static T load(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(char* p, T v) { _mm256_storeu_si256((__m256i*)p, v); }
+    static T set1(char c) { return _mm256_set1_epi8(c); }
+    static T eq(T a, T b) { return _mm256_cmpeq_epi8(a, b); }
+    static T gt(T a, T b) { return _mm256_cmpgt_epi8(a, b); }
+    static T and_(T a, T b) { return _mm256_and_si256(a, b); }
+    static T or_(T a, T b) { return _mm256_or_si256(a, b); }
+    static T xor_(T a, T b) { return _mm256_xor_si256(a, b); }
+    static T subs(T a, T b) { return _mm256_subs_epu8(a, b); }
+    static uint32_t mask(T v) { return (uint32_t)_mm256_movemask_epi8(v); }
+    static bool any(T v) { return !_mm256_testz_si256(v, v); }
+    static T shr4(T v) { return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)); }
+    template <class... B>
+    static T lookup16(T idx, B... table) {
+        // vpshufb looks up within each 128-bit lane, so the table is in both
+        return _mm256_shuffle_epi8(_mm256_setr_epi8(char(table)..., char(table)...), idx);
+    }
+    template <int N>
+    static T prev(T in, T prev_in) {
+        // bytes N..1 before each byte: the upper lane of prev_in and the lower lane of in, then shift
+        return _mm256_alignr_epi8(in, _mm256_permute2x128_si256(prev_in, in, 0x21), 16 - N);
+    }
+    static T incomplete_limits() {
+        return _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+    }
+};
+#include "str_kernels_impl.inc"
+} // namespace avx2
+#pragma GCC pop_options
+
+/** One implementation of every kernel. */
+struct Kernels {
+    const char* name;
+    size_t (*find_byte)(const char*, size_t, char);
+    size_t (*find)(const char*, size_t, const char*, size_t);
+    bool (*equal)(const char*, const char*, size_t);
+    void (*to_lower)(char*, const char*, size_t);
+    bool (*validate_utf8)(const char*, size_t);
+};
+
+#define STRK_KERNELS(ns) {#ns, ns::find_byte, ns::find, ns::equal, ns::to_lower, ns::validate_utf8}
+inline const Kernels ALL[] = {STRK_KERNELS(avx2), STRK_KERNELS(sse42), STRK_KERNELS(scalar)};
+#undef STRK_KERNELS
+
+inline bool supported(const Kernels& k) {
+    if (strcmp(k.name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(k.name, "sse42") == 0)
+        return __builtin_cpu_supports("sse4.2");
+    return true;
+}
+
+inline const Kernels*& active_ptr() {
+    static const Kernels* k = [] {
+        for (const Kernels& k : ALL)
+            if (supported(k))
+                return &k;
+        return &ALL[2];
+    }();
+    return k;
+}
+
+/** The implementation in use: "avx2", "sse42" or "scalar". */
+inline const Kernels& active() { return *active_ptr(); }
+
+/** Switches to the implementation with this name (benchmarks, tests); false if the CPU lacks it. */
+inline bool use(const char* name) {
+    for (const Kernels& k : ALL) {
+        if (strcmp(k.name, name) == 0 && supported(k)) {
+            active_ptr() = &k;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Index of the first c in p[0, n) or npos (memchr). */
+inline size_t find_byte(const char* p, size_t n, char c) { return active().find_byte(p, n, c); }
+
+/** Index of the first occurrence of needle[0, m) in h[0, n) or npos (memmem). */
+inline size_t find(const char* h, size_t n, const char* needle, size_t m) { return active().find(h, n, needle, m); }
+
+/** a[0, n) == b[0, n) (memcmp(...) == 0). */
+inline bool equal(const char* a, const char* b, size_t n) { return active().equal(a, b, n); }
+
+/** ASCII A-Z to a-z, other bytes unchanged; dst may be src. */
+inline void to_lower(char* dst, const char* src, size_t n) { active().to_lower(dst, src, n); }
+
+/** True if p[0, n) is well-formed UTF-8 (no overlongs, surrogates, code points above U+10FFFF). */
+inline bool validate_utf8(const char* p, size_t n) { return active().validate_utf8(p, n); }
+
+} // namespace strk
+
+#endif // STR_KERNELS_HPP
@@ -0,0 +1,66 @@
+// Every implementation of str_kernels.hpp against the scalar one on random and edge-case inputs.
+//   g++ -std=c++17 -fsanitize=address,undefined test.cpp -o test && ./test
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "str_kernels.hpp"
+
+static std::mt19937 rng(1);
+
+// mostly valid UTF-8 of 1..4-byte characters with an occasional random byte
+static std::string random_utf8(size_t chars) {
+    static const char* samples[] = {"a", "Z", "\xD0\x96", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF",
+                                    "\xF4\x8F\xBF\xBF", "\xC2\x80"};
+    static const char* bad[] = {"\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80", "\xFF",
+                                "\xE2\x82", "\xF0\x9F\x98"};
+    std::string s;
+    for (size_t i = 0; i < chars; i++)
+        s += rng() % 200 ? samples[rng() % 8] : bad[rng() % 8];
+    return s;
+}
+
+static void check(const strk::Kernels& k, const std::string& s) {
+    const strk::Kernels& ref = strk::ALL[2];
+    for (char c : {'a', 'Z', '\0', '\x80'})
+        assert(k.find_byte(s.data(), s.size(), c) == ref.find_byte(s.data(), s.size(), c));
+    for (size_t m : {1, 2, 3, 7, 17, 40}) {
+        if (s.size() < m)
+            break;
+        size_t at = rng() % (s.size() - m + 1);
+        std::string needle = s.substr(at, m);
+        assert(k.find(s.data(), s.size(), needle.data(), m) == ref.find(s.data(), s.size(), needle.data(), m));
+        needle.back() ^= 1;
+        assert(k.find(s.data(), s.size(), needle.data(), m) == ref.find(s.data(), s.size(), needle.data(), m));
+    }
+    std::string t = s;
+    assert(k.equal(s.data(), t.data(), s.size()));
+    if (!t.empty()) {
+        t[rng() % t.size()] ^= 4;
+        assert(!k.equal(s.data(), t.data(), s.size()));
+    }
+    std::string a(s.size(), ' '), b(s.size(), ' ');
+    k.to_lower(&a[0], s.data(), s.size());
+    ref.to_lower(&b[0], s.data(), s.size());
+    assert(a == b);
+    assert(k.validate_utf8(s.data(), s.size()) == ref.validate_utf8(s.data(), s.size()));
+}
+
+int main() {
+    for (const strk::Kernels& k : strk::ALL) {
+        if (!strk::supported(k))
+            continue;
+        size_t invalid = 0, total = 0;
+        for (int it = 0; it < 20000; it++) {
+            std::string s = random_utf8(rng() % 120);
+            if (rng() % 4 == 0)
+                s = s.substr(0, s.size() - std::min<size_t>(s.size(), rng() % 3));   // cut a character
+            check(k, s);
+            invalid += !strk::ALL[2].validate_utf8(s.data(), s.size());
+            total++;
+        }
+        std::cout << k.name << " ok (" << invalid << " of " << total << " inputs invalid)" << std::endl;
+    }
+    return 0;
+}
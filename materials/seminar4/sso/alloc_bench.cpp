@@ -0,0 +1,87 @@
+// Heap allocations and time per call of the f(String) / F() patterns of ../move_sem_1.cpp
+// for sso::String and std::string at lengths around the inline capacities (15 and 23).
+//   g++ -O2 -std=c++17 alloc_bench.cpp -o alloc_bench && ./alloc_bench [calls = 1000000]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "string.hpp"
+
+static size_t g_allocs = 0;
+
+void* operator new(size_t n) {
+    g_allocs++;
+    if (void* p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+template <class S>
+__attribute__((noinline)) size_t f(S str) {
+    return str.size();
+}
+
+template <class S>
+__attribute__((noinline)) S F(const char* s) {
+    return S(s);
+}
+
+template <class S>
+__attribute__((noinline)) S F_moved(const char* s) {
+    return std::move(S(s));   // as in move_sem_1.cpp: prevents copy elision, costs a move
+}
+
+struct Result {
+    double allocs;
+    double ns;
+};
+
+template <class Fn>
+static Result measure(Fn fn, int calls) {
+    size_t before = g_allocs;
+    auto t0 = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < calls; i++)
+        sink += fn();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    asm volatile("" : : "r"(sink));
+    return Result{double(g_allocs - before) / calls, s * 1e9 / calls};
+}
+
+template <class S>
+static void run(const char* type, const char* text, int calls) {
+    S s(text);
+    const char* p = text;
+    asm volatile("" : "+r"(p));   // the compiler must not see the literal
+    Result r[] = {
+        measure([&] { return f(s); }, calls),                    // copy into the parameter
+        measure([&] { return f(S(p)); }, calls),                 // construct in place
+        measure([&] { return F<S>(p).size(); }, calls),          // returned with elision
+        measure([&] { return F_moved<S>(p).size(); }, calls),    // returned with std::move
+    };
+    printf("%-12s %4zu", type, strlen(text));
+    for (const Result& x : r)
+        printf("  %6.2f %7.1f", x.allocs, x.ns);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    int calls = argc > 1 ? atoi(argv[1]) : 1000000;
+    static const char* texts[] = {"", "AAAAAAAAAA", "AAAAAAAAAAAAAAA", "AAAAAAAAAAAAAAAA",
+                                  "AAAAAAAAAAAAAAAAAAAAAAA", "AAAAAAAAAAAAAAAAAAAAAAAA",
+                                  "0123456789012345678901234567890123456789012345678901234567890123"};
+    printf("allocations and ns per call\n");
+    printf("%-12s %4s  %14s  %14s  %14s  %14s\n", "type", "len", "f(s)", "f(String(p))", "F()",
+           "F() std::move");
+    for (const char* t : texts) {
+        run<sso::String>("sso::String", t, calls);
+        run<std::string>("std::string", t, calls);
+    }
+    return 0;
+}
@@ -0,0 +1,262 @@
+// String with the small string optimization: what ../move_sem_1.cpp's String grows into, see readme.md.
+//
+// 24 bytes, up to 23 characters inline, no allocation for them. Layout (little endian):
+//   inline: buf[0..22] characters, buf[23] = 23 - size (so it is also the terminator at size 23)
+//   heap:   ptr, size, capacity | HEAP_BIT (the top bit of the last byte)
+#ifndef SSO_STRING_HPP
+#define SSO_STRING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace sso {
+
+class String {
+public:
+    static constexpr size_t INLINE_CAPACITY = 23;
+
+    String() noexcept { set_inline_size(0); }
+
+    String(const char* s) : String(s, strlen(s)) {}
+
+    String(const char* s, size_t n) {
+        char* p = init(n, n);
+        memcpy(p, s, n);
+        p[n] = '\0';
+    }
+
+    explicit String(std::string_view s) : String(s.data(), s.size()) {}
+
+    String(const String& other) {
+        if (other.is_inline()) {
+            memcpy(&rep_, &other.rep_, sizeof(rep_));   // 24 bytes, no branches on the size
+            return;
+        }
+        size_t n = other.rep_.heap.size;
+        memcpy(init(n, n), other.rep_.heap.ptr, n + 1);
+    }
+
+    /** Steals the heap buffer or copies the inline characters; other becomes empty. */
+    String(String&& other) noexcept {
+        memcpy(&rep_, &other.rep_, sizeof(rep_));
+        other.set_inline_size(0);
+    }
+
+    String& operator=(const String& other) {
+        if (this != &other)
+            assign(other.data(), other.size());
+        return *this;
+    }
+
+    String& operator=(String&& other) noexcept {
+        if (this != &other) {
+            release();
+            memcpy(&rep_, &other.rep_, sizeof(rep_));
+            other.set_inline_size(0);
+        }
+        return *this;
+    }
+
+    String& operator=(const char* s) {
+        assign(s, strlen(s));
+        return *this;
+    }
+
+    ~String() { release(); }
+
+    size_t size() const noexcept { return is_inline() ? INLINE_CAPACITY - rep_.buf[INLINE_CAPACITY] : rep_.heap.size; }
+    size_t length() const noexcept { return size(); }
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Characters that fit without reallocation, not counting the terminator. */
+    size_t capacity() const noexcept { return is_inline() ? INLINE_CAPACITY : rep_.heap.cap & ~HEAP_BIT; }
+
+    /** True while the characters are stored in the object itself. */
+    bool is_inline() const noexcept { return (rep_.heap.cap & HEAP_BIT) == 0; }
+
+    const char* data() const noexcept { return is_inline() ? rep_.buf : rep_.heap.ptr; }
+    char* data() noexcept { return is_inline() ? rep_.buf : rep_.heap.ptr; }
+    const char* c_str() const noexcept { return data(); }
+
+    char& operator[](size_t i) noexcept { return data()[i]; }
+    const char& operator[](size_t i) const noexcept { return data()[i]; }
+
+    char& at(size_t i) {
+        if (i >= size())
+            throw std::out_of_range("sso::String::at");
+        return data()[i];
+    }
+
+    char* begin() noexcept { return data(); }
+    char* end() noexcept { return data() + size(); }
+    const char* begin() const noexcept { return data(); }
+    const char* end() const noexcept { return data() + size(); }
+
+    operator std::string_view() const noexcept { return std::string_view(data(), size()); }
+
+    void reserve(size_t n) {
+        if (n > capacity())
+            grow(n);
+    }
+
+    void clear() noexcept { set_size(0); }
+
+    void resize(size_t n, char c = '\0') {
+        size_t old = size();
+        reserve(n);
+        if (n > old)
+            memset(data() + old, c, n - old);
+        set_size(n);
+    }
+
+    String& append(const char* s, size_t n) {
+        size_t old = size();
+        if (old + n > capacity()) {
+            // s may point into this string: it stays valid until grow() frees the old buffer,
+            // so remember its offset
+            const char* d = data();
+            if (s >= d && s < d + old) {
+                size_t off = s - d;
+                grow(std::max(old + n, 2 * capacity()));
+                s = data() + off;
+            } else {
+                grow(std::max(old + n, 2 * capacity()));
+            }
+        }
+        memmove(data() + old, s, n);
+        set_size(old + n);
+        return *this;
+    }
+
+    String& append(std::string_view s) { return append(s.data(), s.size()); }
+    String& operator+=(std::string_view s) { return append(s.data(), s.size()); }
+    String& operator+=(const char* s) { return append(s, strlen(s)); }
+
+    String& operator+=(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c) {
+        size_t old = size();
+        if (old == capacity())
+            grow(2 * capacity());
+        data()[old] = c;
+        set_size(old + 1);
+    }
+
+    /** Returns a heap buffer that is larger than needed to the inline storage or a tighter one. */
+    void shrink_to_fit() {
+        if (is_inline() || capacity() == size())
+            return;
+        String tmp(data(), size());
+        *this = std::move(tmp);
+    }
+
+    void swap(String& other) noexcept {
+        Rep t;
+        memcpy(&t, &rep_, sizeof(t));
+        memcpy(&rep_, &other.rep_, sizeof(t));
+        memcpy(&other.rep_, &t, sizeof(t));
+    }
+
+    friend bool operator==(const String& a, const String& b) noexcept {
+        return std::string_view(a) == std::string_view(b);
+    }
+    friend bool operator!=(const String& a, const String& b) noexcept { return !(a == b); }
+    friend bool operator<(const String& a, const String& b) noexcept {
+        return std::string_view(a) < std::string_view(b);
+    }
+
+    friend String operator+(const String& a, std::string_view b) {
+        String r;
+        r.reserve(a.size() + b.size());
+        r.append(a.data(), a.size());
+        r.append(b);
+        return r;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const String& s) {
+        return out.write(s.data(), s.size());
+    }
+
+private:
+    static constexpr size_t HEAP_BIT = size_t(1) << (8 * sizeof(size_t) - 1);
+
+    struct Heap {
+        char* ptr;
+        size_t size;
+        size_t cap;   // without the terminator, HEAP_BIT set
+    };
+
+    union Rep {
+        Heap heap;
+        char buf[sizeof(Heap)];
+    } rep_;
+
+    static_assert(sizeof(Rep) == INLINE_CAPACITY + 1, "inline buffer must overlay the heap representation");
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "HEAP_BIT must be in the last byte");
+
+    void set_inline_size(size_t n) noexcept {
+        rep_.buf[INLINE_CAPACITY] = (char)(INLINE_CAPACITY - n);
+        rep_.buf[n] = '\0';
+    }
+
+    void set_size(size_t n) noexcept {
+        if (is_inline()) {
+            set_inline_size(n);
+        } else {
+            rep_.heap.size = n;
+            rep_.heap.ptr[n] = '\0';
+        }
+    }
+
+    // storage for n characters (capacity cap >= n) in an empty object, returns where to write them
+    char* init(size_t n, size_t cap) {
+        if (cap <= INLINE_CAPACITY) {
+            set_inline_size(n);
+            return rep_.buf;
+        }
+        rep_.heap.ptr = new char[cap + 1];
+        rep_.heap.size = n;
+        rep_.heap.cap = cap | HEAP_BIT;
+        return rep_.heap.ptr;
+    }
+
+    void release() noexcept {
+        if (!is_inline())
+            delete[] rep_.heap.ptr;
+    }
+
+    void grow(size_t cap) {
+        size_t n = size();
+        char* p = new char[cap + 1];
+        memcpy(p, data(), n + 1);
+        release();
+        rep_.heap.ptr = p;
+        rep_.heap.size = n;
+        rep_.heap.cap = cap | HEAP_BIT;
+    }
+
+    void assign(const char* s, size_t n) {
+        if (n > capacity()) {
+            String tmp(s, n);
+            *this = std::move(tmp);
+            return;
+        }
+        memmove(data(), s, n);
+        set_size(n);
+    }
+};
+
+inline void swap(String& a, String& b) noexcept { a.swap(b); }
+
+} // namespace sso
+
+#endif // SSO_STRING_HPP
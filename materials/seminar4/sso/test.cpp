@@ -0,0 +1,75 @@
+// Checks of sso::String around the inline/heap boundary.
+//   g++ -std=c++17 -fsanitize=address,undefined test.cpp -o test && ./test
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "string.hpp"
+
+using sso::String;
+
+static void check(const String& s, const std::string& expected) {
+    assert(s.size() == expected.size());
+    assert(std::string(s.c_str()) == expected);   // terminated
+    assert(s.capacity() >= s.size());
+    assert(s.is_inline() == (s.capacity() == String::INLINE_CAPACITY));
+}
+
+static void test_boundary() {
+    for (size_t n = 0; n <= 64; n++) {
+        std::string expected(n, 'x');
+        String s(expected.c_str());
+        check(s, expected);
+        assert(s.is_inline() == (n <= String::INLINE_CAPACITY));
+        String copy(s);
+        check(copy, expected);
+        String moved(std::move(copy));
+        check(moved, expected);
+        check(copy, "");
+        assert(copy.is_inline());
+    }
+}
+
+static void test_append() {
+    String s;
+    std::string expected;
+    for (int i = 0; i < 100; i++) {
+        s += char('a' + i % 26);
+        expected += char('a' + i % 26);
+        check(s, expected);
+    }
+    s.append(s.data(), s.size());   // aliasing source
+    expected += expected;
+    check(s, expected);
+    s.clear();
+    check(s, "");
+    s.shrink_to_fit();
+    assert(s.is_inline());
+}
+
+static void test_assign() {
+    String small("abc"), big(std::string(40, 'y').c_str());
+    String s;
+    s = big;
+    check(s, std::string(40, 'y'));
+    s = small;                       // keeps the heap buffer
+    check(s, "abc");
+    assert(!s.is_inline());
+    s = std::move(big);
+    check(s, std::string(40, 'y'));
+    s = s;
+    check(s, std::string(40, 'y'));
+    String t("t");
+    swap(s, t);
+    check(s, "t");
+    check(t, std::string(40, 'y'));
+    assert(String("ab") < String("b") && String("ab") == String("ab") && String("a") != String("ab"));
+    check(String("ab") + "cd", "abcd");
+}
+
+int main() {
+    test_boundary();
+    test_append();
+    test_assign();
+    std::cout << "ok" << std::endl;
+    return 0;
+}